@@ -0,0 +1,42 @@
+#include "anomaly_hampel.h"
+#include <algorithm>
+#include <cmath>
+#include "../utils/robust_stats.h"
+
+std::vector<int> detectAnomaliesHampel(std::span<const double> series,
+                                       int window_size,
+                                       double threshold) {
+    std::vector<int> anomaly_indices;
+    RollingMedianMAD stats(window_size);
+
+    for (size_t i = 0; i < series.size(); ++i) {
+        stats.add(series[i]);
+
+        if (stats.ready()) {
+            RobustStats window = stats.stats();
+            double robust_std = window.mad * 1.4826;
+
+            // A zero MAD (e.g. a flat window) would flag every differing value
+            if (robust_std > 1e-10 && std::abs(series[i] - window.median) > threshold * robust_std) {
+                anomaly_indices.push_back(static_cast<int>(i));
+            }
+        }
+    }
+
+    return anomaly_indices;
+}
+
+std::vector<int> detectAnomaliesHampelByTicker(const std::vector<TickerSeries>& partitions,
+                                               int window_size,
+                                               double threshold) {
+    std::vector<int> anomaly_indices;
+
+    for (const auto& partition : partitions) {
+        for (int idx : detectAnomaliesHampel(partition.values, window_size, threshold)) {
+            anomaly_indices.push_back(partition.row_indices[idx]);
+        }
+    }
+
+    std::sort(anomaly_indices.begin(), anomaly_indices.end());
+    return anomaly_indices;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <span>
+#include <vector>
+#include "../utils/ticker_partition.h"
+
+/**
+ * Rolling Hampel filter: flags points more than threshold robust standard deviations
+ * (MAD * 1.4826) from the median of the last window_size values, the point included.
+ * Unlike the mean/stddev sliding window, the very outliers being hunted don't inflate
+ * the window statistics. Each tick costs an O(W) sorted insert/erase and O(log W) for the
+ * median/MAD (see RollingMedianMAD for the large-window tree path).
+ * @param series: Input time series data
+ * @param window_size: Number of values in the rolling window
+ * @param threshold: Threshold in robust standard deviations
+ * @return: Vector of indices where anomalies were detected
+ */
+std::vector<int> detectAnomaliesHampel(std::span<const double> series,
+                                       int window_size,
+                                       double threshold);
+
+// Runs the Hampel filter independently on each ticker's series. Returns sorted global row indices.
+std::vector<int> detectAnomaliesHampelByTicker(const std::vector<TickerSeries>& partitions,
+                                               int window_size,
+                                               double threshold);
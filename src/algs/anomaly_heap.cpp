@@ -1,118 +1,150 @@
 #include "anomaly_heap.h"
+#include "../utils/detector_log.h"
+#include "../utils/phase_timer.h"
+#include "../utils/robust_stats.h"
 #include <algorithm>
 #include <cmath>
-#include <iostream>
+#include <iomanip>
 #include <numeric>
 
-std::vector<int> detectAnomaliesHeap(const std::vector<double>& data, double threshold) {
-    std::vector<int> anomalies;
-    
-    if (data.empty()) {
-        return anomalies;
-    }
-    
-    // Calculate robust statistics using median and MAD (Median Absolute Deviation)
-    std::vector<double> sorted_data = data;
-    std::sort(sorted_data.begin(), sorted_data.end());
-    
-    // Calculate median
-    double median;
-    size_t n = sorted_data.size();
-    if (n % 2 == 0) {
-        median = (sorted_data[n/2 - 1] + sorted_data[n/2]) / 2.0;
-    } else {
-        median = sorted_data[n/2];
-    }
-    
-    // Calculate MAD (Median Absolute Deviation)
-    std::vector<double> deviations;
-    deviations.reserve(data.size());
-    for (double value : data) {
-        deviations.push_back(std::abs(value - median));
-    }
-    std::sort(deviations.begin(), deviations.end());
-    
-    double mad;
-    if (n % 2 == 0) {
-        mad = (deviations[n/2 - 1] + deviations[n/2]) / 2.0;
-    } else {
-        mad = deviations[n/2];
-    }
-    
-    // Convert MAD to standard deviation equivalent (MAD * 1.4826)
-    double robust_std = mad * 1.4826;
+namespace {
+
+// Convert MAD to standard deviation equivalent (MAD * 1.4826)
+double robustStd(const RobustStats& stats) {
+    double robust_std = stats.mad * 1.4826;
     
     // Prevent division by zero
     if (robust_std < 1e-10) {
         robust_std = 1e-10;
     }
+    return robust_std;
+}
+
+// Use a more conservative threshold approach
+// For financial data, use a higher base threshold
+double adaptiveThreshold(double threshold) {
+    return std::max(threshold, 2.0);
+}
+
+// Must exceed threshold with a 20% buffer to be significantly different
+double selectionCutoff(double threshold) {
+    return adaptiveThreshold(threshold) * 1.2;
+}
+
+// Selection order shared by the heap and the sweep: larger deviation first, and among
+// equal deviations the earlier row, so both keep the same rows when ties hit the cap
+bool strongerCandidate(const std::pair<double, int>& a, const std::pair<double, int>& b) {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+// Limit to a reasonable percentage of the data (similar to sliding window)
+size_t maxAnomalies(size_t n) {
+    return static_cast<size_t>(n * 0.05); // Max 5% of data
+}
+
+} // namespace
+
+std::vector<int> detectAnomaliesHeap(std::span<const double> data, double threshold) {
+    std::vector<int> anomalies;
     
-    // Use a more conservative threshold approach
-    // Scale threshold based on data characteristics
-    double adaptive_threshold = threshold;
-    
-    // For financial data, use a higher base threshold
-    if (threshold < 2.0) {
-        adaptive_threshold = std::max(threshold, 2.0);
+    if (data.empty()) {
+        return anomalies;
     }
     
-    // Create min-heap for tracking the most extreme deviations
+    // Calculate robust statistics using median and MAD (Median Absolute Deviation)
+    // Both come from selection over one scratch buffer rather than two full sorts
+    RobustStats stats = computeMedianMAD(data);
+    double median = stats.median;
+    double robust_std = robustStd(stats);
+    
+    double adaptive_threshold = adaptiveThreshold(threshold);
+    size_t max_anomalies = maxAnomalies(data.size());
+    double cutoff = selectionCutoff(threshold);
+    
+    // Bounded min-heap of the most extreme deviations seen so far: the weakest
+    // candidate sits on top and is evicted when a stronger one arrives, so only
+    // max_anomalies entries are ever kept (O(n log k) time, O(k) memory)
     std::priority_queue<std::pair<double, int>, 
                        std::vector<std::pair<double, int>>, 
-                       std::greater<std::pair<double, int>>> min_heap;
-    
-    // Calculate normalized deviations and identify potential anomalies
-    std::vector<std::pair<double, int>> deviation_pairs;
-    deviation_pairs.reserve(data.size());
+                       decltype(&strongerCandidate)> min_heap(&strongerCandidate);
+    double max_deviation = 0.0;
     
     for (size_t i = 0; i < data.size(); ++i) {
         double normalized_deviation = std::abs(data[i] - median) / robust_std;
-        deviation_pairs.push_back({normalized_deviation, static_cast<int>(i)});
-    }
-    
-    // Sort by deviation (largest first)
-    std::sort(deviation_pairs.begin(), deviation_pairs.end(), 
-              [](const auto& a, const auto& b) { return a.first > b.first; });
-    
-    // Select top anomalies more conservatively
-    // Limit to a reasonable percentage of the data (similar to sliding window)
-    size_t max_anomalies = static_cast<size_t>(data.size() * 0.05); // Max 5% of data
-    size_t selected_anomalies = 0;
-    
-    // Use both threshold and ranking approach
-    for (const auto& pair : deviation_pairs) {
-        double deviation = pair.first;
-        int index = pair.second;
+        max_deviation = std::max(max_deviation, normalized_deviation);
         
-        // Must exceed threshold AND be in top percentile
-        if (deviation > adaptive_threshold && selected_anomalies < max_anomalies) {
-            // Additional filter: ensure it's significantly different
-            if (deviation > adaptive_threshold * 1.2) {  // 20% buffer above threshold
-                anomalies.push_back(index);
-                selected_anomalies++;
-            }
-        } else {
-            break; // Stop if we've found enough or threshold not met
+        if (normalized_deviation <= cutoff || max_anomalies == 0) {
+            continue;
         }
+        std::pair<double, int> candidate{normalized_deviation, static_cast<int>(i)};
+        if (min_heap.size() < max_anomalies) {
+            min_heap.push(candidate);
+        } else if (strongerCandidate(candidate, min_heap.top())) {
+            min_heap.pop();
+            min_heap.push(candidate);
+        }
+    }
+    
+    anomalies.reserve(min_heap.size());
+    while (!min_heap.empty()) {
+        anomalies.push_back(min_heap.top().second);
+        min_heap.pop();
     }
     
     // Sort anomaly indices
     std::sort(anomalies.begin(), anomalies.end());
     
-    // Debug output
-    std::cout << "Heap algorithm detected " << anomalies.size() << " anomalies" << std::endl;
-    if (!deviation_pairs.empty()) {
-        std::cout << "Max deviation: " << deviation_pairs[0].first << std::endl;
+    DETECTOR_LOG(Info, "Heap algorithm detected " << anomalies.size() << " anomalies");
+    DETECTOR_LOG(Debug, "Max deviation: " << max_deviation);
+    DETECTOR_LOG(Debug, "Median: " << median << ", Robust STD: " << robust_std);
+    DETECTOR_LOG(Debug, "Adaptive threshold: " << adaptive_threshold);
+    
+    return anomalies;
+}
+
+HeapThresholdSweep::HeapThresholdSweep(std::span<const double> data)
+    : max_anomalies(maxAnomalies(data.size())) {
+    if (data.empty()) return;
+    
+    RobustStats stats = computeMedianMAD(data);
+    median_value = stats.median;
+    robust_std = robustStd(stats);
+    
+    ranked.reserve(data.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+        ranked.push_back({std::abs(data[i] - median_value) / robust_std, static_cast<int>(i)});
     }
-    std::cout << "Median: " << median << ", Robust STD: " << robust_std << std::endl;
-    std::cout << "Adaptive threshold: " << adaptive_threshold << std::endl;
     
+    // Largest deviation first; ties keep the earlier row first
+    std::sort(ranked.begin(), ranked.end(), strongerCandidate);
+}
+
+size_t HeapThresholdSweep::countAt(double threshold) const {
+    double cutoff = selectionCutoff(threshold);
+    auto end = std::partition_point(ranked.begin(), ranked.end(),
+                                    [cutoff](const auto& entry) { return entry.first > cutoff; });
+    return std::min(static_cast<size_t>(end - ranked.begin()), max_anomalies);
+}
+
+std::vector<int> HeapThresholdSweep::anomaliesAt(double threshold) const {
+    size_t count = countAt(threshold);
+    std::vector<int> anomalies;
+    anomalies.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        anomalies.push_back(ranked[i].second);
+    }
+    std::sort(anomalies.begin(), anomalies.end());
     return anomalies;
 }
 
+double HeapThresholdSweep::maxDeviation() const {
+    return ranked.empty() ? 0.0 : ranked.front().first;
+}
+
 // Alternative function with granular threshold search that's more conservative
-std::vector<int> detectAnomaliesHeapGranular(const std::vector<double>& data,
+std::vector<int> detectAnomaliesHeapGranular(std::span<const double> data,
                                             double target_percentage) {
+    PROFILE_PHASE_ROWS("heap granular", data.size());
     if (data.empty()) {
         return {};
     }
@@ -129,43 +161,87 @@ std::vector<int> detectAnomaliesHeapGranular(const std::vector<double>& data,
     }
     
     double best_threshold = 3.5;
-    std::vector<int> best_anomalies;
     double best_diff = std::numeric_limits<double>::max();
     
-    std::cout << "=== HEAP-BASED DETECTION (GRANULAR SEARCH) ===" << std::endl;
-    std::cout << "Target anomaly rate: " << (target_percentage * 100) << "%" << std::endl;
-    std::cout << "Generated " << thresholds.size() << " threshold values to test" << std::endl;
+    DETECTOR_LOG(Info, "=== HEAP-BASED DETECTION (GRANULAR SEARCH) ===");
+    DETECTOR_LOG(Info, "Target anomaly rate: " << (target_percentage * 100) << "%");
+    DETECTOR_LOG(Debug, "Generated " << thresholds.size() << " threshold values to test");
+    
+    // Median, MAD and the ranked deviations don't depend on the threshold, so they
+    // are computed once; each candidate is then just a binary search
+    HeapThresholdSweep sweep(data);
+    DETECTOR_LOG(Debug, std::fixed << std::setprecision(6) << "Median: " << sweep.median()
+                 << ", Robust STD: " << sweep.robustStdDev() << ", Max deviation: " << sweep.maxDeviation());
     
     int attempt = 1;
     for (double threshold : thresholds) {
-        std::cout << "[" << attempt << "/" << thresholds.size() << "] ";
-        std::cout << "Trying threshold " << std::fixed << std::setprecision(6) << threshold << "..." << std::endl;
+        DETECTOR_LOG(Debug, "[" << attempt << "/" << thresholds.size() << "] "
+                     << "Trying threshold " << std::fixed << std::setprecision(6) << threshold << "...");
         
-        auto anomalies = detectAnomaliesHeap(data, threshold);
-        double percentage = static_cast<double>(anomalies.size()) / data.size();
+        size_t count = sweep.countAt(threshold);
+        double percentage = static_cast<double>(count) / data.size();
         
-        std::cout << "Found " << anomalies.size() << " anomalies (" 
-                  << std::fixed << std::setprecision(5) << (percentage * 100) << "%)" << std::endl;
+        DETECTOR_LOG(Debug, "Found " << count << " anomalies ("
+                     << std::fixed << std::setprecision(5) << (percentage * 100) << "%)");
         
         // Check if this is closer to our target
         double diff = std::abs(percentage - target_percentage);
         if (diff < best_diff) {
             best_diff = diff;
             best_threshold = threshold;
-            best_anomalies = anomalies;
         }
         
         // If we're close enough, stop searching
         if (percentage <= target_percentage * 1.2 && percentage >= target_percentage * 0.8) {
-            std::cout << "✓ Good detection rate achieved!" << std::endl;
+            DETECTOR_LOG(Debug, "✓ Good detection rate achieved!");
             break;
         } else if (percentage > target_percentage * 2) {
-            std::cout << "⚠ Too many anomalies, trying higher threshold..." << std::endl;
+            DETECTOR_LOG(Debug, "⚠ Too many anomalies, trying higher threshold...");
         }
         
         attempt++;
     }
     
-    std::cout << "🎯 Using best threshold found: " << best_threshold << std::endl;
-    return best_anomalies;
+    DETECTOR_LOG(Info, std::fixed << std::setprecision(6) << "🎯 Using best threshold found: " << best_threshold);
+    return sweep.anomaliesAt(best_threshold);
+}
+
+QuantileDetection detectAnomaliesHeapQuantile(std::span<const double> data, double target_fraction) {
+    PROFILE_PHASE_ROWS("heap quantile", data.size());
+    QuantileDetection result;
+    size_t n = data.size();
+    if (n == 0) {
+        return result;
+    }
+    
+    // After computeMedianMAD the scratch buffer holds every |x - median| (in no
+    // particular order), which is exactly what the quantile has to be selected from
+    std::vector<double> scratch;
+    RobustStats stats = computeMedianMAD(data, scratch);
+    result.median = stats.median;
+    result.robust_std = robustStd(stats);
+    
+    // NaN would pass through clamp and llround to a huge k; treat it as "flag nothing"
+    double target = std::isnan(target_fraction) ? 0.0 : std::clamp(target_fraction, 0.0, 1.0);
+    size_t k = static_cast<size_t>(std::llround(target * static_cast<double>(n)));
+    if (k >= n) {
+        result.anomalies.resize(n);
+        std::iota(result.anomalies.begin(), result.anomalies.end(), 0);
+        return result;
+    }
+    
+    // The (k+1)-th largest deviation: everything strictly above it is flagged
+    auto cut = scratch.begin() + static_cast<std::ptrdiff_t>(n - k - 1);
+    std::nth_element(scratch.begin(), cut, scratch.end());
+    double cutoff = *cut;
+    result.threshold = cutoff / result.robust_std;
+    
+    result.anomalies.reserve(k);
+    for (size_t i = 0; i < n; ++i) {
+        if (std::abs(data[i] - stats.median) > cutoff) {
+            result.anomalies.push_back(static_cast<int>(i));
+        }
+    }
+    
+    return result;
 }
\ No newline at end of file
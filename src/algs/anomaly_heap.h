@@ -1,10 +1,10 @@
 #ifndef ANOMALY_HEAP_H
 #define ANOMALY_HEAP_H
 
+#include <span>
+#include <utility>
 #include <vector>
 #include <queue>
-#include <iostream>
-#include <iomanip>
 
 /**
  * Detect anomalies using an improved heap-based approach with robust statistics
@@ -12,7 +12,32 @@
  * @param threshold: Threshold for anomaly detection (in terms of robust standard deviations)
  * @return: Vector of indices where anomalies were detected
  */
-std::vector<int> detectAnomaliesHeap(const std::vector<double>& data, double threshold);
+std::vector<int> detectAnomaliesHeap(std::span<const double> data, double threshold);
+
+/**
+ * Ranks every point by its robust deviation once, so the heap detector can be
+ * evaluated at many thresholds without recomputing the median, MAD or ordering.
+ * countAt() is O(log n); anomaliesAt() returns the same indices as
+ * detectAnomaliesHeap(data, threshold). When ties at the 5% cap leave a choice, both
+ * keep the earliest rows among equal deviations.
+ */
+class HeapThresholdSweep {
+public:
+    explicit HeapThresholdSweep(std::span<const double> data);
+
+    size_t countAt(double threshold) const;
+    std::vector<int> anomaliesAt(double threshold) const;
+
+    double median() const { return median_value; }
+    double robustStdDev() const { return robust_std; }
+    double maxDeviation() const;
+
+private:
+    std::vector<std::pair<double, int>> ranked;  // (normalized deviation, index), largest first
+    size_t max_anomalies;
+    double median_value = 0.0;
+    double robust_std = 0.0;
+};
 
 /**
  * Detect anomalies using granular threshold search to achieve target detection rate
@@ -20,7 +45,28 @@ std::vector<int> detectAnomaliesHeap(const std::vector<double>& data, double thr
  * @param target_percentage: Target percentage of data points to flag as anomalies (default: 3%)
  * @return: Vector of indices where anomalies were detected
  */
-std::vector<int> detectAnomaliesHeapGranular(const std::vector<double>& data, 
+std::vector<int> detectAnomaliesHeapGranular(std::span<const double> data, 
                                            double target_percentage = 0.03);
 
+/**
+ * Result of a quantile-targeted detection
+ * threshold: implied cutoff in robust standard deviations; points strictly above it are flagged
+ */
+struct QuantileDetection {
+    std::vector<int> anomalies;
+    double threshold = 0.0;
+    double median = 0.0;
+    double robust_std = 0.0;
+};
+
+/**
+ * Flag a target fraction of the data directly: the cutoff is the order statistic of the
+ * robust z-scores that leaves round(target_fraction * n) points above it, found with one
+ * selection pass (no threshold search). Ties at the cutoff can return slightly fewer points.
+ * @param data: Input time series data
+ * @param target_fraction: Fraction of points to flag, e.g. 0.035 for 3.5%; clamped to [0, 1], NaN flags nothing
+ * @return: Sorted anomaly indices plus the implied threshold
+ */
+QuantileDetection detectAnomaliesHeapQuantile(std::span<const double> data, double target_fraction);
+
 #endif // ANOMALY_HEAP_H
\ No newline at end of file
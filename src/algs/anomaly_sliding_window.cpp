@@ -1,9 +1,12 @@
 #include "anomaly_sliding_window.h"
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <numeric>
+#include "../utils/prefix_moments.h"
 #include "../utils/rolling_stats.h"
 
-std::vector<int> detectAnomaliesSlidingWindow(const std::vector<double>& series, 
+std::vector<int> detectAnomaliesSlidingWindow(std::span<const double> series, 
                                              int window_size, 
                                              double threshold) {
     std::vector<int> anomaly_indices;  
@@ -23,4 +26,100 @@ std::vector<int> detectAnomaliesSlidingWindow(const std::vector<double>& series,
     }
 
     return anomaly_indices;
+}
+
+std::vector<int> detectAnomaliesSlidingWindowByTicker(const std::vector<TickerSeries>& partitions,
+                                                      int window_size,
+                                                      double threshold) {
+    std::vector<int> anomaly_indices;
+
+    for (const auto& partition : partitions) {
+        auto local = detectAnomaliesSlidingWindow(partition.values, window_size, threshold);
+
+        // Map positions within the ticker's series back to rows of the full table
+        for (int idx : local) {
+            anomaly_indices.push_back(partition.row_indices[idx]);
+        }
+    }
+
+    std::sort(anomaly_indices.begin(), anomaly_indices.end());
+    return anomaly_indices;
+}
+
+
+namespace {
+
+SlidingWindowSweep makeSweep(size_t rows,
+                             const std::vector<int>& window_sizes,
+                             const std::vector<double>& thresholds) {
+    SlidingWindowSweep sweep;
+    sweep.window_sizes = window_sizes;
+    sweep.thresholds = thresholds;
+    sweep.rows = rows;
+    size_t cells = window_sizes.size() * thresholds.size();
+    sweep.counts.assign(cells, 0);
+    sweep.masks.assign(cells, AnomalyMask(rows));
+    return sweep;
+}
+
+// Adds the grid results for one series into sweep, with series position i mapped to row_of(i)
+template <typename RowOf>
+void sweepSeries(std::span<const double> series, SlidingWindowSweep& sweep, RowOf row_of) {
+    PrefixMoments moments(series);
+
+    // Thresholds ascending, so testing can stop at the first one a point doesn't exceed
+    std::vector<size_t> order(sweep.thresholds.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](size_t a, size_t b) { return sweep.thresholds[a] < sweep.thresholds[b]; });
+
+    std::vector<size_t> windows;
+    windows.reserve(sweep.window_sizes.size());
+    for (int window_size : sweep.window_sizes) {
+        windows.push_back(static_cast<size_t>(std::max(window_size, 1)));
+    }
+
+    // One pass over the series: each point is scored against every window that has filled
+    for (size_t i = 0; i < series.size(); ++i) {
+        size_t row = row_of(i);
+
+        for (size_t w = 0; w < windows.size(); ++w) {
+            if (i + 1 < windows[w]) continue;
+
+            double mean, stddev;
+            moments.window(i + 1 - windows[w], i + 1, mean, stddev);
+            double deviation = std::abs(series[i] - mean);
+
+            for (size_t t : order) {
+                if (!(deviation > sweep.thresholds[t] * stddev)) break;
+
+                size_t cell = sweep.cell(w, t);
+                sweep.masks[cell].set(row);
+                ++sweep.counts[cell];
+            }
+        }
+    }
+}
+
+} // namespace
+
+SlidingWindowSweep detectAnomaliesSlidingWindowSweep(std::span<const double> series,
+                                                     const std::vector<int>& window_sizes,
+                                                     const std::vector<double>& thresholds) {
+    SlidingWindowSweep sweep = makeSweep(series.size(), window_sizes, thresholds);
+    sweepSeries(series, sweep, [](size_t i) { return i; });
+    return sweep;
+}
+
+SlidingWindowSweep detectAnomaliesSlidingWindowSweepByTicker(const std::vector<TickerSeries>& partitions,
+                                                             size_t total_rows,
+                                                             const std::vector<int>& window_sizes,
+                                                             const std::vector<double>& thresholds) {
+    SlidingWindowSweep sweep = makeSweep(total_rows, window_sizes, thresholds);
+    for (const auto& partition : partitions) {
+        sweepSeries(partition.values, sweep, [&](size_t i) {
+            return static_cast<size_t>(partition.row_indices[i]);
+        });
+    }
+    return sweep;
 }
\ No newline at end of file
@@ -1,6 +1,49 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
 #include <vector>
+#include "../utils/anomaly_mask.h"
+#include "../utils/ticker_partition.h"
 
-std::vector<int> detectAnomaliesSlidingWindow(const std::vector<double>& series, 
+std::vector<int> detectAnomaliesSlidingWindow(std::span<const double> series, 
                                              int window_size, 
-                                             double threshold);
\ No newline at end of file
+                                             double threshold);
+
+// Runs the sliding window independently on each ticker's own series, so a window
+// never mixes different stocks. Returns sorted global row indices.
+std::vector<int> detectAnomaliesSlidingWindowByTicker(const std::vector<TickerSeries>& partitions,
+                                                      int window_size,
+                                                      double threshold);
+
+// Anomaly counts and row masks for every (window size, threshold) pair of a parameter grid.
+// Cells are stored row-major: cell (w, t) is at w * thresholds.size() + t.
+struct SlidingWindowSweep {
+    std::vector<int> window_sizes;
+    std::vector<double> thresholds;
+    size_t rows = 0;
+    std::vector<size_t> counts;
+    std::vector<AnomalyMask> masks;  // bit i set when row i is flagged
+
+    size_t cell(size_t w, size_t t) const { return w * thresholds.size() + t; }
+    size_t count(size_t w, size_t t) const { return counts[cell(w, t)]; }
+    bool flagged(size_t w, size_t t, size_t row) const {
+        return masks[cell(w, t)].test(row);
+    }
+};
+
+// Evaluates the sliding-window rule for a whole grid of window sizes and thresholds in
+// one pass over the series, scoring each point against every window size. Window
+// statistics come from prefix sums of x and x^2 shared by every window size, and each
+// point is tested against the thresholds in ascending order, so the cost is
+// O(n * windows + flagged cells) instead of one full run per combination. Results
+// match detectAnomaliesSlidingWindow up to floating-point rounding at the threshold.
+SlidingWindowSweep detectAnomaliesSlidingWindowSweep(std::span<const double> series,
+                                                     const std::vector<int>& window_sizes,
+                                                     const std::vector<double>& thresholds);
+
+// Grid sweep run per ticker; masks are over global rows [0, total_rows)
+SlidingWindowSweep detectAnomaliesSlidingWindowSweepByTicker(const std::vector<TickerSeries>& partitions,
+                                                             size_t total_rows,
+                                                             const std::vector<int>& window_sizes,
+                                                             const std::vector<double>& thresholds);
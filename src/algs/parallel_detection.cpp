@@ -0,0 +1,94 @@
+#include "parallel_detection.h"
+#include <algorithm>
+#include <numeric>
+#include "anomaly_hampel.h"
+#include "anomaly_heap.h"
+#include "anomaly_sliding_window.h"
+#include "../utils/phase_timer.h"
+
+namespace {
+
+[[maybe_unused]] size_t totalRows(const std::vector<TickerSeries>& partitions) {
+    size_t rows = 0;
+    for (const TickerSeries& partition : partitions) rows += partition.values.size();
+    return rows;
+}
+
+// Runs detect(values) for every ticker on the pool and merges the hits as global row indices
+template <typename Detector>
+std::vector<int> runPerTicker(const std::vector<TickerSeries>& partitions,
+                              WorkStealingPool& pool,
+                              [[maybe_unused]] const char* phase,
+                              Detector detect) {
+    PROFILE_PHASE_ROWS(phase, totalRows(partitions));
+
+    // Longest series first
+    std::vector<size_t> order(partitions.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return partitions[a].values.size() > partitions[b].values.size();
+    });
+
+    // Each task writes only its own slot, so no locking is needed
+    std::vector<std::vector<int>> results(partitions.size());
+    pool.parallelFor(order.size(), [&](size_t task) {
+        const TickerSeries& partition = partitions[order[task]];
+        auto local = detect(partition.values);
+
+        std::vector<int>& out = results[order[task]];
+        out.reserve(local.size());
+        for (int idx : local) {
+            out.push_back(partition.row_indices[idx]);
+        }
+    });
+
+    std::vector<int> anomaly_indices;
+    for (const auto& hits : results) {
+        anomaly_indices.insert(anomaly_indices.end(), hits.begin(), hits.end());
+    }
+    std::sort(anomaly_indices.begin(), anomaly_indices.end());
+    return anomaly_indices;
+}
+
+} // namespace
+
+std::vector<int> detectAnomaliesSlidingWindowParallel(const std::vector<TickerSeries>& partitions,
+                                                      int window_size,
+                                                      double threshold,
+                                                      WorkStealingPool& pool) {
+    return runPerTicker(partitions, pool, "sliding window", [&](const std::vector<double>& values) {
+        return detectAnomaliesSlidingWindow(values, window_size, threshold);
+    });
+}
+
+std::vector<int> detectAnomaliesSlidingWindowParallel(const std::vector<TickerSeries>& partitions,
+                                                      int window_size,
+                                                      double threshold,
+                                                      unsigned num_threads) {
+    WorkStealingPool pool(num_threads);
+    return detectAnomaliesSlidingWindowParallel(partitions, window_size, threshold, pool);
+}
+
+std::vector<int> detectAnomaliesHeapParallel(const std::vector<TickerSeries>& partitions,
+                                             double threshold,
+                                             WorkStealingPool& pool) {
+    return runPerTicker(partitions, pool, "heap per ticker", [&](const std::vector<double>& values) {
+        return detectAnomaliesHeap(values, threshold);
+    });
+}
+
+std::vector<int> detectAnomaliesHeapParallel(const std::vector<TickerSeries>& partitions,
+                                             double threshold,
+                                             unsigned num_threads) {
+    WorkStealingPool pool(num_threads);
+    return detectAnomaliesHeapParallel(partitions, threshold, pool);
+}
+
+std::vector<int> detectAnomaliesHampelParallel(const std::vector<TickerSeries>& partitions,
+                                               int window_size,
+                                               double threshold,
+                                               WorkStealingPool& pool) {
+    return runPerTicker(partitions, pool, "hampel", [&](const std::vector<double>& values) {
+        return detectAnomaliesHampel(values, window_size, threshold);
+    });
+}
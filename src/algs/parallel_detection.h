@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include "../utils/thread_pool.h"
+#include "../utils/ticker_partition.h"
+
+// Per-ticker detectors scheduled across a work-stealing pool, one task per ticker.
+// Tickers are queued longest-first so a skewed universe doesn't leave one thread
+// finishing a giant series alone. Results are merged in a fixed order and sorted,
+// so the output is identical for any thread count.
+
+std::vector<int> detectAnomaliesSlidingWindowParallel(const std::vector<TickerSeries>& partitions,
+                                                      int window_size,
+                                                      double threshold,
+                                                      WorkStealingPool& pool);
+
+std::vector<int> detectAnomaliesSlidingWindowParallel(const std::vector<TickerSeries>& partitions,
+                                                      int window_size,
+                                                      double threshold,
+                                                      unsigned num_threads = 0);
+
+// Runs detectAnomaliesHeap on each ticker's series with that ticker's own median/MAD
+std::vector<int> detectAnomaliesHeapParallel(const std::vector<TickerSeries>& partitions,
+                                             double threshold,
+                                             WorkStealingPool& pool);
+
+std::vector<int> detectAnomaliesHeapParallel(const std::vector<TickerSeries>& partitions,
+                                             double threshold,
+                                             unsigned num_threads = 0);
+
+// Runs the rolling median/MAD (Hampel) filter on each ticker's series
+std::vector<int> detectAnomaliesHampelParallel(const std::vector<TickerSeries>& partitions,
+                                               int window_size,
+                                               double threshold,
+                                               WorkStealingPool& pool);
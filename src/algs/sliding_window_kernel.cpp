@@ -0,0 +1,214 @@
+#include "sliding_window_kernel.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SLIDING_KERNEL_X86 1
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC 12's AVX-512 headers trip a false -Wmaybe-uninitialized on _mm512_undefined_pd
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#else
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TARGET_AVX2
+#define TARGET_AVX512
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+#endif
+
+namespace {
+
+// Everything a kernel needs for one block of points. sum/sum_sq are prefix sums of
+// x - shift and (x - shift)^2 over the block's span, which starts at series index
+// first, so point i's window is [i + 1 - window, i + 1) minus first in the prefixes.
+struct KernelInput {
+    const double* series;
+    const double* sum;
+    const double* sum_sq;
+    size_t first;
+    size_t window;
+    double shift;
+    double inv_window;
+    double threshold;
+};
+
+// Mean of x[0, len), with four accumulators so the adds don't form one serial chain
+double spanMean(const double* x, size_t len) {
+    double a = 0.0, b = 0.0, c = 0.0, d = 0.0;
+    size_t j = 0;
+    for (; j + 4 <= len; j += 4) {
+        a += x[j];
+        b += x[j + 1];
+        c += x[j + 2];
+        d += x[j + 3];
+    }
+    for (; j < len; ++j) a += x[j];
+    return ((a + b) + (c + d)) / static_cast<double>(len);
+}
+
+// sum[j] and sum_sq[j] = sums of x - shift and (x - shift)^2 over x[0, j), for j <= len.
+// Each group of four is added up off the dependency chain, so the running totals
+// advance once per group rather than once per value.
+void buildPrefix(const double* x, size_t len, double shift, double* sum, double* sum_sq) {
+    double s = 0.0, q = 0.0;
+    sum[0] = 0.0;
+    sum_sq[0] = 0.0;
+    size_t j = 0;
+    for (; j + 4 <= len; j += 4) {
+        double d0 = x[j] - shift, d1 = x[j + 1] - shift, d2 = x[j + 2] - shift, d3 = x[j + 3] - shift;
+        double s01 = d0 + d1, s012 = s01 + d2, s0123 = s01 + (d2 + d3);
+        double q0 = d0 * d0, q01 = q0 + d1 * d1, q012 = q01 + d2 * d2, q0123 = q01 + (d2 * d2 + d3 * d3);
+
+        sum[j + 1] = s + d0;
+        sum[j + 2] = s + s01;
+        sum[j + 3] = s + s012;
+        sum_sq[j + 1] = q + q0;
+        sum_sq[j + 2] = q + q01;
+        sum_sq[j + 3] = q + q012;
+        s += s0123;
+        q += q0123;
+        sum[j + 4] = s;
+        sum_sq[j + 4] = q;
+    }
+    for (; j < len; ++j) {
+        double d = x[j] - shift;
+        s += d;
+        q += d * d;
+        sum[j + 1] = s;
+        sum_sq[j + 1] = q;
+    }
+}
+
+// Kernels OR each point's verdict into bit i of the mask words. The vector kernels
+// must start at a multiple of 8 so a group of lanes never straddles two words.
+
+// Scalar reference, also used for the head and tail the vector kernels leave over
+void scalarKernel(const KernelInput& in, size_t begin, size_t end, uint64_t* mask) {
+    for (size_t i = begin; i < end; ++i) {
+        size_t hi = i + 1 - in.first, lo = hi - in.window;
+        double s = in.sum[hi] - in.sum[lo];
+        double s2 = in.sum_sq[hi] - in.sum_sq[lo];
+
+        double mean = s * in.inv_window;
+        double variance = s2 * in.inv_window - mean * mean;
+        double stddev = std::sqrt(variance > 0.0 ? variance : 0.0);
+        double deviation = std::abs((in.series[i] - in.shift) - mean);
+        mask[i / 64] |= uint64_t{deviation > in.threshold * stddev} << (i % 64);
+    }
+}
+
+#ifdef SLIDING_KERNEL_X86
+
+TARGET_AVX2 size_t avx2Kernel(const KernelInput& in, size_t begin, size_t end, uint64_t* mask) {
+    const __m256d inv_window = _mm256_set1_pd(in.inv_window);
+    const __m256d threshold = _mm256_set1_pd(in.threshold);
+    const __m256d shift = _mm256_set1_pd(in.shift);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        size_t hi = i + 1 - in.first, lo = hi - in.window;
+        __m256d s = _mm256_sub_pd(_mm256_loadu_pd(in.sum + hi), _mm256_loadu_pd(in.sum + lo));
+        __m256d s2 = _mm256_sub_pd(_mm256_loadu_pd(in.sum_sq + hi), _mm256_loadu_pd(in.sum_sq + lo));
+
+        __m256d mean = _mm256_mul_pd(s, inv_window);
+        __m256d variance = _mm256_sub_pd(_mm256_mul_pd(s2, inv_window), _mm256_mul_pd(mean, mean));
+        __m256d stddev = _mm256_sqrt_pd(_mm256_max_pd(variance, zero));
+        __m256d x = _mm256_sub_pd(_mm256_loadu_pd(in.series + i), shift);
+        __m256d deviation = _mm256_andnot_pd(sign_mask, _mm256_sub_pd(x, mean));
+
+        int bits = _mm256_movemask_pd(_mm256_cmp_pd(deviation, _mm256_mul_pd(threshold, stddev), _CMP_GT_OQ));
+        mask[i / 64] |= static_cast<uint64_t>(bits) << (i % 64);
+    }
+    return i;
+}
+
+TARGET_AVX512 size_t avx512Kernel(const KernelInput& in, size_t begin, size_t end, uint64_t* mask) {
+    const __m512d inv_window = _mm512_set1_pd(in.inv_window);
+    const __m512d threshold = _mm512_set1_pd(in.threshold);
+    const __m512d shift = _mm512_set1_pd(in.shift);
+    const __m512d zero = _mm512_setzero_pd();
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        size_t hi = i + 1 - in.first, lo = hi - in.window;
+        __m512d s = _mm512_sub_pd(_mm512_loadu_pd(in.sum + hi), _mm512_loadu_pd(in.sum + lo));
+        __m512d s2 = _mm512_sub_pd(_mm512_loadu_pd(in.sum_sq + hi), _mm512_loadu_pd(in.sum_sq + lo));
+
+        __m512d mean = _mm512_mul_pd(s, inv_window);
+        __m512d variance = _mm512_sub_pd(_mm512_mul_pd(s2, inv_window), _mm512_mul_pd(mean, mean));
+        __m512d stddev = _mm512_sqrt_pd(_mm512_max_pd(variance, zero));
+        __m512d x = _mm512_sub_pd(_mm512_loadu_pd(in.series + i), shift);
+        __m512d deviation = _mm512_abs_pd(_mm512_sub_pd(x, mean));
+
+        __mmask8 bits = _mm512_cmp_pd_mask(deviation, _mm512_mul_pd(threshold, stddev), _CMP_GT_OQ);
+        mask[i / 64] |= static_cast<uint64_t>(bits) << (i % 64);
+    }
+    return i;
+}
+
+#endif // SLIDING_KERNEL_X86
+
+} // namespace
+
+size_t slidingWindowBlockSize(int window_size) {
+    return std::max<size_t>(512, 8 * static_cast<size_t>(std::max(window_size, 1)));
+}
+
+AnomalyMask slidingWindowMask(std::span<const double> series,
+                              int window_size,
+                              double threshold,
+                              SimdLevel level) {
+    AnomalyMask mask(series.size());
+    if (window_size < 1 || series.size() < static_cast<size_t>(window_size)) {
+        return mask;
+    }
+
+    size_t window = static_cast<size_t>(window_size);
+    size_t block = slidingWindowBlockSize(window_size);
+    uint64_t* words = mask.mutableWords().data();
+    // Prefixes over one block's span: the block plus the window - 1 values before it
+    std::vector<double> sum(block + window), sum_sq(block + window);
+
+    // Points before the window fills stay 0, like the stateful path's warm-up. Each
+    // block's prefix sums are built and tested while its span is still in cache.
+    for (size_t begin = window - 1; begin < series.size(); begin += block) {
+        size_t end = std::min(series.size(), begin + block);
+        size_t first = begin + 1 - window;
+        double shift = spanMean(series.data() + first, end - first);
+        buildPrefix(series.data() + first, end - first, shift, sum.data(), sum_sq.data());
+
+        KernelInput in{series.data(), sum.data(), sum_sq.data(), first, window,
+                       shift, 1.0 / window_size, threshold};
+        size_t i = begin;
+#ifdef SLIDING_KERNEL_X86
+        if (level != SimdLevel::Scalar) {
+            size_t aligned = std::min(end, (i + 7) & ~size_t{7});
+            scalarKernel(in, i, aligned, words);
+            i = level == SimdLevel::AVX512 ? avx512Kernel(in, aligned, end, words)
+                                           : avx2Kernel(in, aligned, end, words);
+        }
+#else
+        (void)level;
+#endif
+        scalarKernel(in, i, end, words);
+    }
+    return mask;
+}
+
+std::vector<int> detectAnomaliesSlidingWindowBatch(std::span<const double> series,
+                                                   int window_size,
+                                                   double threshold,
+                                                   SimdLevel level) {
+    std::vector<int> anomaly_indices;
+    slidingWindowMask(series, window_size, threshold, level)
+        .forEach([&](uint64_t row) { anomaly_indices.push_back(static_cast<int>(row)); });
+    return anomaly_indices;
+}
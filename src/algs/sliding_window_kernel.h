@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "../utils/anomaly_mask.h"
+#include "../utils/cpu_features.h"
+
+/**
+ * Stateless batch form of detectAnomaliesSlidingWindow for offline runs. The series is
+ * processed in blocks of slidingWindowBlockSize(window_size) points: each block's span
+ * (the block plus the window - 1 values before it) is shifted by its mean and turned
+ * into prefix sums of x and x^2 in a cache-sized scratch buffer, and the threshold test
+ * then runs over the whole block with AVX-512, AVX2 or scalar code, picked at runtime.
+ * The series is read once per block, plus the window - 1 lead-in values.
+ *
+ * Tolerance: with L the span length (at most block size + W) and s^2 the span's
+ * variance, a window's mean is off by at most about eps * L^2 / W * s and its variance
+ * by eps * L^2 / W * s^2, so a verdict can differ from exact moments only where
+ *   | |x - mean| - threshold * stddev | <= eps * L^2 / W * (s + threshold * s^2 / stddev)
+ * RollingStats' running updates drift by their own rounding, so the stateful path can
+ * also differ where that margin is within ~1e-9 * stddev. Project3_check compares the
+ * verdicts with exact moments and with detectAnomaliesSlidingWindow at every SimdLevel.
+ *
+ * @return: One bit per point, set where an anomaly was detected (clear during warm-up)
+ */
+AnomalyMask slidingWindowMask(std::span<const double> series,
+                              int window_size,
+                              double threshold,
+                              SimdLevel level = detectSimdLevel());
+
+// Points per block: several windows long, so re-summing the lead-in stays cheap
+size_t slidingWindowBlockSize(int window_size);
+
+// Same as slidingWindowMask, returned as anomaly indices like detectAnomaliesSlidingWindow
+std::vector<int> detectAnomaliesSlidingWindowBatch(std::span<const double> series,
+                                                   int window_size,
+                                                   double threshold,
+                                                   SimdLevel level = detectSimdLevel());
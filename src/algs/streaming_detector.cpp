@@ -0,0 +1,68 @@
+#include "streaming_detector.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+StreamingSlidingWindowDetector::StreamingSlidingWindowDetector(int window_size, double threshold)
+    : window_size(window_size), threshold(threshold) {}
+
+StreamVerdict StreamingSlidingWindowDetector::push(std::string_view ticker, int64_t timestamp, double value) {
+    auto it = tickers.find(ticker);
+    if (it == tickers.end()) {
+        it = tickers.emplace(std::string(ticker),
+                             TickerState{RollingStats(window_size), std::numeric_limits<int64_t>::min()}).first;
+    }
+    TickerState& state = it->second;
+
+    StreamVerdict verdict;
+    if (timestamp < state.last_timestamp) {
+        verdict.status = StreamVerdict::Status::OutOfOrder;
+        return verdict;
+    }
+    state.last_timestamp = timestamp;
+
+    // Same rule as detectAnomaliesSlidingWindow: the tick is part of its own window
+    state.stats.add(value);
+    if (!state.stats.ready()) {
+        return verdict;
+    }
+
+    verdict.center = state.stats.mean();
+    verdict.scale = state.stats.stddev();
+    verdict.status = std::abs(value - verdict.center) > threshold * verdict.scale
+                         ? StreamVerdict::Status::Anomaly
+                         : StreamVerdict::Status::Normal;
+    return verdict;
+}
+
+StreamingHeapDetector::StreamingHeapDetector(double threshold,
+                                             double relative_accuracy,
+                                             size_t refresh_interval,
+                                             size_t min_samples)
+    : threshold(threshold),
+      refresh_interval(std::max<size_t>(refresh_interval, 1)),
+      min_samples(min_samples),
+      stats(relative_accuracy) {}
+
+StreamVerdict StreamingHeapDetector::push(double value) {
+    stats.add(value);
+
+    StreamVerdict verdict;
+    if (stats.count() < min_samples) {
+        return verdict;
+    }
+
+    // Refresh on the first scored tick and then every refresh_interval ticks
+    if (since_refresh == 0 || ++since_refresh >= refresh_interval) {
+        current = stats.stats();
+        since_refresh = 1;
+    }
+
+    verdict.center = current.median;
+    // Convert MAD to standard deviation equivalent, with the batch detector's floor
+    verdict.scale = std::max(current.mad * 1.4826, 1e-10);
+    verdict.status = std::abs(value - verdict.center) > threshold * verdict.scale
+                         ? StreamVerdict::Status::Anomaly
+                         : StreamVerdict::Status::Normal;
+    return verdict;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "../utils/robust_stats.h"
+#include "../utils/rolling_stats.h"
+#include "../utils/string_hash.h"
+
+// Outcome of scoring one tick
+struct StreamVerdict {
+    enum class Status {
+        Warmup,      // the ticker's window isn't full yet, no verdict possible
+        Normal,
+        Anomaly,
+        OutOfOrder   // timestamp is older than the ticker's last tick; ignored
+    };
+
+    Status status = Status::Warmup;
+    double center = 0.0;  // mean (sliding window) or median (robust) after adding the tick
+    double scale = 0.0;   // stddev (sliding window) or robust std (MAD * 1.4826)
+
+    bool isAnomaly() const { return status == Status::Anomaly; }
+};
+
+// Online version of the per-ticker sliding-window detector: ticks are pushed one
+// at a time and scored immediately against that ticker's RollingStats. Memory is
+// one window per ticker and history is never rescanned. Fed the same per-ticker
+// sequence, it flags exactly what detectAnomaliesSlidingWindow flags in batch.
+class StreamingSlidingWindowDetector {
+public:
+    StreamingSlidingWindowDetector(int window_size, double threshold);
+
+    // timestamp is any monotonically increasing clock per ticker (day number, epoch ms, ...)
+    StreamVerdict push(std::string_view ticker, int64_t timestamp, double value);
+
+    size_t tickerCount() const { return tickers.size(); }
+
+private:
+    struct TickerState {
+        RollingStats stats;
+        int64_t last_timestamp;
+    };
+
+    int window_size;
+    double threshold;
+    std::unordered_map<std::string, TickerState, TransparentStringHash, std::equal_to<>> tickers;
+};
+
+// Streaming robust z-score test: each value is scored against the median/MAD of
+// everything seen so far, kept in a StreamingRobustStats sketch (O(sketch) memory, see
+// its error bound). Querying the sketch walks its buckets, so the median/MAD are
+// refreshed every refresh_interval ticks, keeping push() O(1) amortized. No verdicts
+// are given before min_samples values.
+//
+// threshold is a plain cutoff: a value is flagged when |x - median| > threshold * MAD *
+// 1.4826. Unlike detectAnomaliesHeap there is no 2.0 floor, no 20% buffer and no 5% cap
+// on the number flagged, so the same threshold flags more. Passing
+// max(t, 2.0) * 1.2 gives detectAnomaliesHeap(data, t)'s cutoff, still without the cap.
+class StreamingHeapDetector {
+public:
+    StreamingHeapDetector(double threshold,
+                          double relative_accuracy = 0.01,
+                          size_t refresh_interval = 256,
+                          size_t min_samples = 100);
+
+    StreamVerdict push(double value);
+
+    const StreamingRobustStats& sketch() const { return stats; }
+
+private:
+    double threshold;
+    size_t refresh_interval;
+    size_t min_samples;
+    StreamingRobustStats stats;
+    RobustStats current;
+    size_t since_refresh = 0;
+};
@@ -0,0 +1,164 @@
+#include "bench_harness.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string_view>
+
+namespace {
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::vector<std::unique_ptr<Benchmark>>& registry() {
+    static std::vector<std::unique_ptr<Benchmark>> benchmarks;
+    return benchmarks;
+}
+
+// Runs fn with increasing iteration counts until one run lasts min_time_ns
+BenchState measure(const Benchmark& bench, const std::vector<int64_t>& values, double min_time_ns) {
+    uint64_t iterations = 1;
+    while (true) {
+        BenchState state(values, iterations);
+        bench.run(state);
+        if (state.skipped() || state.elapsedNs() >= min_time_ns || iterations >= 1'000'000'000) {
+            return state;
+        }
+
+        // Aim 40% past the target so the next run usually is the last one
+        double per_iteration = std::max(state.elapsedNs() / iterations, 1.0);
+        uint64_t next = static_cast<uint64_t>(min_time_ns * 1.4 / per_iteration);
+        iterations = std::clamp<uint64_t>(next, iterations + 1, iterations * 100);
+    }
+}
+
+} // namespace
+
+BenchState::BenchState(const std::vector<int64_t>& args, uint64_t iterations)
+    : args(args), total_iterations(iterations) {}
+
+void BenchState::start() {
+    running = true;
+    started_allocations = allocationSnapshot();
+    started_ns = nowNs();
+}
+
+void BenchState::stop() {
+    if (!running) return;
+    elapsed_ns += static_cast<double>(nowNs() - started_ns);
+    AllocationSnapshot now = allocationSnapshot();
+    allocation_count += now.count - started_allocations.count;
+    allocation_bytes += now.bytes - started_allocations.bytes;
+    running = false;
+}
+
+void BenchState::pauseTiming() {
+    stop();
+}
+
+void BenchState::resumeTiming() {
+    start();
+}
+
+void BenchState::skipWithError(std::string message) {
+    error = std::move(message);
+}
+
+Benchmark::Benchmark(std::string name, std::function<void(BenchState&)> fn)
+    : bench_name(std::move(name)), fn(std::move(fn)) {}
+
+Benchmark* Benchmark::args(std::vector<int64_t> values) {
+    arg_sets.push_back(std::move(values));
+    return this;
+}
+
+Benchmark* Benchmark::argsProduct(const std::vector<std::vector<int64_t>>& lists) {
+    std::vector<std::vector<int64_t>> product = {{}};
+    for (const auto& list : lists) {
+        std::vector<std::vector<int64_t>> next;
+        for (const auto& prefix : product) {
+            for (int64_t value : list) {
+                next.push_back(prefix);
+                next.back().push_back(value);
+            }
+        }
+        product = std::move(next);
+    }
+    for (auto& values : product) arg_sets.push_back(std::move(values));
+    return this;
+}
+
+Benchmark* Benchmark::argNames(std::vector<std::string> names) {
+    arg_names = std::move(names);
+    return this;
+}
+
+std::string Benchmark::displayName(const std::vector<int64_t>& values) const {
+    std::string display = bench_name;
+    for (size_t i = 0; i < values.size(); ++i) {
+        display += '/';
+        if (i < arg_names.size()) display += arg_names[i] + ":";
+        display += std::to_string(values[i]);
+    }
+    return display;
+}
+
+Benchmark* registerBenchmark(const std::string& name, std::function<void(BenchState&)> fn) {
+    registry().push_back(std::make_unique<Benchmark>(name, std::move(fn)));
+    return registry().back().get();
+}
+
+int runBenchmarks(int argc, char** argv) {
+    std::string filter;
+    double min_time = 0.2;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--filter=")) filter = arg.substr(9);
+        if (arg.starts_with("--min_time=")) min_time = std::stod(std::string(arg.substr(11)));
+    }
+
+    std::printf("%-52s %14s %12s %12s %12s %12s\n",
+                "Benchmark", "Time/iter", "Iterations", "ns/row", "allocs/row", "bytes/row");
+    std::printf("%s\n", std::string(119, '-').c_str());
+
+    for (const auto& bench : registry()) {
+        std::vector<std::vector<int64_t>> arg_sets = bench->argSets();
+        if (arg_sets.empty()) arg_sets.push_back({});
+
+        for (const auto& values : arg_sets) {
+            std::string display = bench->displayName(values);
+            if (!filter.empty() && display.find(filter) == std::string::npos) continue;
+
+            BenchState state = measure(*bench, values, min_time * 1e9);
+            if (state.skipped()) {
+                std::printf("%-52s SKIPPED: %s\n", display.c_str(), state.errorMessage().c_str());
+                continue;
+            }
+
+            double iterations = static_cast<double>(state.iterations());
+            double rows = iterations * static_cast<double>(std::max<uint64_t>(state.rowsPerIteration(), 1));
+            double per_iteration_ns = state.elapsedNs() / iterations;
+            const char* unit = "ns";
+            double scaled = per_iteration_ns;
+            if (scaled >= 1e6) {
+                scaled /= 1e6;
+                unit = "ms";
+            } else if (scaled >= 1e3) {
+                scaled /= 1e3;
+                unit = "us";
+            }
+
+            std::printf("%-52s %11.3f %s %12llu %12.2f %12.4f %12.2f\n",
+                        display.c_str(), scaled, unit,
+                        static_cast<unsigned long long>(state.iterations()),
+                        state.elapsedNs() / rows,
+                        static_cast<double>(state.allocations()) / rows,
+                        static_cast<double>(state.allocatedBytes()) / rows);
+            std::fflush(stdout);
+        }
+    }
+
+    return 0;
+}
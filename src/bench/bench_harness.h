@@ -0,0 +1,130 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "../utils/allocation_counter.h"
+
+// Minimal Google-Benchmark-style harness. Benchmarks are plain functions taking a
+// BenchState, registered with BENCHMARK(fn)->args(...), and written as
+//
+//     static void BM_Foo(BenchState& state) {
+//         auto input = makeInput(state.range(0));      // untimed setup
+//         for (auto _ : state) doNotOptimize(foo(input));
+//         state.setRowsPerIteration(input.size());
+//     }
+//
+// The runner grows the iteration count until the timed loop lasts --min_time seconds
+// and reports time per iteration, ns/row and heap allocations/row (counted by the
+// replacement operator new in utils/allocation_counter.cpp).
+
+class BenchState {
+public:
+    BenchState(const std::vector<int64_t>& args, uint64_t iterations);
+
+    int64_t range(size_t i) const { return args[i]; }
+    uint64_t iterations() const { return total_iterations; }
+
+    // Rows each iteration processes; ns/row and allocations/row are divided by it
+    void setRowsPerIteration(uint64_t rows) { rows_per_iteration = rows; }
+
+    // Excludes setup inside the loop from both the timer and the allocation counts
+    void pauseTiming();
+    void resumeTiming();
+
+    // Marks the run as skipped (e.g. missing data file); the loop body won't run
+    void skipWithError(std::string message);
+
+    struct Sentinel {};
+    // Loop variable type; [[maybe_unused]] keeps `for (auto _ : state)` clear of
+    // -Wunused-variable
+    struct [[maybe_unused]] Tick {};
+    class Iterator {
+    public:
+        explicit Iterator(BenchState* state) : state(state), remaining(state->loopCount()) {}
+        Tick operator*() const { return {}; }
+        Iterator& operator++() { --remaining; return *this; }
+        bool operator!=(Sentinel) {
+            if (remaining != 0) return true;
+            state->stop();
+            return false;
+        }
+
+    private:
+        BenchState* state;
+        uint64_t remaining;
+    };
+
+    Iterator begin() { start(); return Iterator(this); }
+    Sentinel end() { return {}; }
+
+    // Filled in once the loop finishes
+    double elapsedNs() const { return elapsed_ns; }
+    uint64_t allocations() const { return allocation_count; }
+    uint64_t allocatedBytes() const { return allocation_bytes; }
+    uint64_t rowsPerIteration() const { return rows_per_iteration; }
+    bool skipped() const { return !error.empty(); }
+    const std::string& errorMessage() const { return error; }
+
+private:
+    uint64_t loopCount() const { return skipped() ? 0 : total_iterations; }
+    void start();
+    void stop();
+
+    std::vector<int64_t> args;
+    uint64_t total_iterations;
+    uint64_t rows_per_iteration = 1;
+    std::string error;
+
+    bool running = false;
+    int64_t started_ns = 0;
+    AllocationSnapshot started_allocations;
+    double elapsed_ns = 0.0;
+    uint64_t allocation_count = 0;
+    uint64_t allocation_bytes = 0;
+};
+
+class Benchmark {
+public:
+    Benchmark(std::string name, std::function<void(BenchState&)> fn);
+
+    // One argument set per call, e.g. ->args({100000, 30})
+    Benchmark* args(std::vector<int64_t> values);
+    // Every combination of the given lists, e.g. ->argsProduct({{10000, 1000000}, {30, 250}})
+    Benchmark* argsProduct(const std::vector<std::vector<int64_t>>& lists);
+    // Labels printed before each argument, e.g. ->argNames({"n", "window"})
+    Benchmark* argNames(std::vector<std::string> names);
+
+    const std::string& name() const { return bench_name; }
+    std::string displayName(const std::vector<int64_t>& values) const;
+    const std::vector<std::vector<int64_t>>& argSets() const { return arg_sets; }
+    void run(BenchState& state) const { fn(state); }
+
+private:
+    std::string bench_name;
+    std::function<void(BenchState&)> fn;
+    std::vector<std::vector<int64_t>> arg_sets;
+    std::vector<std::string> arg_names;
+};
+
+Benchmark* registerBenchmark(const std::string& name, std::function<void(BenchState&)> fn);
+
+// Runs every registered benchmark whose name contains --filter=<text>, each for at least
+// --min_time=<seconds> (default 0.2). Other arguments are ignored. Returns the exit code.
+int runBenchmarks(int argc, char** argv);
+
+#define BENCH_CONCAT_INNER(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_INNER(a, b)
+#define BENCHMARK(fn) \
+    static Benchmark* BENCH_CONCAT(bench_registration_, __LINE__) = registerBenchmark(#fn, fn)
+
+// Keeps value (and the work that produced it) from being optimized away
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
@@ -0,0 +1,420 @@
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench_harness.h"
+#include "../algs/anomaly_hampel.h"
+#include "../algs/anomaly_heap.h"
+#include "../algs/anomaly_sliding_window.h"
+#include "../algs/sliding_window_kernel.h"
+#include "../utils/buffered_writer.h"
+#include "../utils/csv_utils.h"
+#include "../utils/feature_cache.h"
+#include "../utils/robust_stats.h"
+#include "../utils/rolling_stats.h"
+
+// Microbenchmarks for the CSV loaders, RollingStats and the detectors, each over
+// synthetic data of size n and over the real features.csv (the "_Real" variants).
+//   Project3_bench [--data=../data/features.csv] [--filter=Sliding] [--min_time=0.5]
+
+static std::string g_data_filename = "../data/features.csv";
+
+// Synthetic daily-return-like series so the benchmark doesn't depend on data/
+static const std::vector<double>& syntheticSeries(size_t n) {
+    static std::map<size_t, std::vector<double>> cache;
+    auto it = cache.find(n);
+    if (it != cache.end()) return it->second;
+
+    std::mt19937_64 rng(42);
+    std::normal_distribution<double> dist(0.0005, 0.02);
+    std::vector<double> series(n);
+    for (double& v : series) v = dist(rng);
+    return cache.emplace(n, std::move(series)).first->second;
+}
+
+// Daily returns of the real data set, loaded once; empty if the file is missing
+static const std::vector<double>& realSeries() {
+    static const std::vector<double> series = [] {
+        FeatureTable table;
+        if (!read_feature_table(g_data_filename, table, {FeatureColumn::DailyReturn})) {
+            return std::vector<double>();
+        }
+        return std::move(table.daily_return);
+    }();
+    return series;
+}
+
+// features.csv-shaped files of synthetic data, written once per n and removed at exit
+static std::map<size_t, std::string> g_synthetic_csvs;
+
+static const std::string& syntheticCsv(size_t n) {
+    auto it = g_synthetic_csvs.find(n);
+    if (it != g_synthetic_csvs.end()) return it->second;
+
+    std::string filename = (std::filesystem::temp_directory_path() /
+                            ("project3_bench_" + std::to_string(n) + ".csv")).string();
+    const auto& returns = syntheticSeries(n);
+    std::ofstream out(filename);
+    out << ",Date,Close,High,Low,Open,Volume,Ticker,Daily Return,Volatility,Volume Z-Score\n";
+    const char* tickers[] = {"AAPL", "MSFT", "NVDA", "TSLA", "JPM"};
+    double price = 100.0;
+    for (size_t i = 0; i < n; ++i) {
+        price *= 1.0 + returns[i];
+        char date[16];
+        std::snprintf(date, sizeof(date), "%04zu-%02zu-%02zu", 2000 + i / 336 % 50, i / 28 % 12 + 1, i % 28 + 1);
+        out << i << ',' << date << ','
+            << price << ',' << price * 1.01 << ',' << price * 0.99 << ',' << price << ','
+            << 1000000 + i % 5000 * 100 << ',' << tickers[i % 5] << ','
+            << returns[i] << ',' << std::abs(returns[i]) * 1.5 << ',' << returns[i] * 50.0 << '\n';
+    }
+    return g_synthetic_csvs.emplace(n, filename).first->second;
+}
+
+static void removeSyntheticCsvs() {
+    for (const auto& [n, filename] : g_synthetic_csvs) {
+        std::remove(filename.c_str());
+    }
+}
+
+// Benchmarks taking the series from synthetic data (range(0) = n) or the real file
+static const std::vector<double>* seriesFor(BenchState& state, bool real) {
+    const std::vector<double>& series = real ? realSeries() : syntheticSeries(state.range(0));
+    if (series.empty()) {
+        state.skipWithError("could not load " + g_data_filename);
+        return nullptr;
+    }
+    return &series;
+}
+
+// Reference implementation of the old getline/stringstream/stod reader, kept for comparison
+static std::vector<StockRow> readFeaturesGetline(const std::string& filename) {
+    std::vector<StockRow> data;
+    std::ifstream file(filename);
+    std::string line;
+    std::getline(file, line);
+
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string cell;
+        StockRow row;
+
+        std::getline(ss, row.date, ',');
+        std::getline(ss, cell, ','); row.open = std::stod(cell);
+        std::getline(ss, cell, ','); row.high = std::stod(cell);
+        std::getline(ss, cell, ','); row.low = std::stod(cell);
+        std::getline(ss, cell, ','); row.close = std::stod(cell);
+        std::getline(ss, cell, ','); row.adj_close = std::stod(cell);
+        std::getline(ss, cell, ','); row.volume = std::stod(cell);
+        std::getline(ss, row.ticker, ',');
+        std::getline(ss, cell, ','); row.daily_return = std::stod(cell);
+        std::getline(ss, cell, ','); row.volatility = std::stod(cell);
+        std::getline(ss, cell, ','); row.volume_zscore = std::stod(cell);
+
+        data.push_back(row);
+    }
+    return data;
+}
+
+// Reference implementation of the old recompute-every-tick approach, kept for comparison
+static double naiveTick(std::deque<double>& window, size_t window_size, double value) {
+    if (window.size() == window_size) window.pop_front();
+    window.push_back(value);
+    double m = std::accumulate(window.begin(), window.end(), 0.0) / window.size();
+    double sq_sum = 0.0;
+    for (double v : window) sq_sum += (v - m) * (v - m);
+    return m + std::sqrt(sq_sum / window.size());
+}
+
+// === CSV parsing ===
+
+enum class CsvLoader { Getline, Rows, Projected, Table, Cache };
+
+static void runCsvLoad(BenchState& state, const std::string& filename, CsvLoader loader) {
+    if (!std::filesystem::exists(filename)) {
+        state.skipWithError("could not open " + filename);
+        return;
+    }
+
+    // The cache variant reads a scratch cache so the real one is left alone
+    std::string cache_filename = filename + ".bench.p3cache";
+    if (loader == CsvLoader::Cache) {
+        FeatureTable table;
+        if (!read_feature_table(filename, table) || !writeFeatureCache(cache_filename, filename, table)) {
+            std::remove(cache_filename.c_str());
+            state.skipWithError("could not write " + cache_filename);
+            return;
+        }
+    }
+
+    size_t rows = 0;
+    for (auto _ : state) {
+        switch (loader) {
+            case CsvLoader::Getline: {
+                auto data = readFeaturesGetline(filename);
+                rows = data.size();
+                doNotOptimize(data.data());
+                break;
+            }
+            case CsvLoader::Rows: {
+                auto data = read_features_csv(filename);
+                rows = data.size();
+                doNotOptimize(data.data());
+                break;
+            }
+            case CsvLoader::Projected: {
+                std::vector<std::vector<double>> columns;
+                std::vector<std::string> tickers;
+                read_feature_columns(filename, {FeatureColumn::DailyReturn}, columns, &tickers);
+                rows = tickers.size();
+                doNotOptimize(columns.data());
+                break;
+            }
+            case CsvLoader::Table: {
+                FeatureTable table;
+                read_feature_table(filename, table, {FeatureColumn::DailyReturn});
+                rows = table.size();
+                doNotOptimize(table.daily_return.data());
+                break;
+            }
+            case CsvLoader::Cache: {
+                FeatureTable table;
+                // A stale or unreadable cache would otherwise time an empty table
+                if (!readFeatureCache(cache_filename, filename, table, {FeatureColumn::DailyReturn})) {
+                    state.skipWithError("could not read " + cache_filename);
+                    break;
+                }
+                rows = table.size();
+                doNotOptimize(table.daily_return.data());
+                break;
+            }
+        }
+        if (state.skipped()) break;
+    }
+    state.setRowsPerIteration(rows);
+
+    if (loader == CsvLoader::Cache) std::remove(cache_filename.c_str());
+}
+
+static void BM_CsvGetline(BenchState& state) { runCsvLoad(state, syntheticCsv(state.range(0)), CsvLoader::Getline); }
+static void BM_CsvRows(BenchState& state) { runCsvLoad(state, syntheticCsv(state.range(0)), CsvLoader::Rows); }
+static void BM_CsvProjected(BenchState& state) { runCsvLoad(state, syntheticCsv(state.range(0)), CsvLoader::Projected); }
+static void BM_CsvTable(BenchState& state) { runCsvLoad(state, syntheticCsv(state.range(0)), CsvLoader::Table); }
+static void BM_CsvCache(BenchState& state) { runCsvLoad(state, syntheticCsv(state.range(0)), CsvLoader::Cache); }
+static void BM_CsvGetline_Real(BenchState& state) { runCsvLoad(state, g_data_filename, CsvLoader::Getline); }
+static void BM_CsvRows_Real(BenchState& state) { runCsvLoad(state, g_data_filename, CsvLoader::Rows); }
+static void BM_CsvProjected_Real(BenchState& state) { runCsvLoad(state, g_data_filename, CsvLoader::Projected); }
+static void BM_CsvTable_Real(BenchState& state) { runCsvLoad(state, g_data_filename, CsvLoader::Table); }
+static void BM_CsvCache_Real(BenchState& state) { runCsvLoad(state, g_data_filename, CsvLoader::Cache); }
+
+BENCHMARK(BM_CsvGetline)->argNames({"n"})->args({10000})->args({100000});
+BENCHMARK(BM_CsvRows)->argNames({"n"})->args({10000})->args({100000});
+BENCHMARK(BM_CsvProjected)->argNames({"n"})->args({10000})->args({100000});
+BENCHMARK(BM_CsvTable)->argNames({"n"})->args({10000})->args({100000});
+BENCHMARK(BM_CsvCache)->argNames({"n"})->args({10000})->args({100000});
+BENCHMARK(BM_CsvGetline_Real);
+BENCHMARK(BM_CsvRows_Real);
+BENCHMARK(BM_CsvProjected_Real);
+BENCHMARK(BM_CsvTable_Real);
+BENCHMARK(BM_CsvCache_Real);
+
+// === RollingStats add/mean/stddev ===
+
+static void BM_RollingStats(BenchState& state) {
+    const auto& series = syntheticSeries(state.range(0));
+    int window_size = static_cast<int>(state.range(1));
+    for (auto _ : state) {
+        RollingStats stats(window_size);
+        double sink = 0.0;
+        for (double v : series) {
+            stats.add(v);
+            sink += stats.mean() + stats.stddev();
+        }
+        doNotOptimize(sink);
+    }
+    state.setRowsPerIteration(series.size());
+}
+
+// Compile-time capacity variant for the default 30-day window
+static void BM_RollingStatsFixed30(BenchState& state) {
+    const auto& series = syntheticSeries(state.range(0));
+    for (auto _ : state) {
+        BasicRollingStats<30> stats;
+        double sink = 0.0;
+        for (double v : series) {
+            stats.add(v);
+            sink += stats.mean() + stats.stddev();
+        }
+        doNotOptimize(sink);
+    }
+    state.setRowsPerIteration(series.size());
+}
+
+static void BM_RollingStatsNaive(BenchState& state) {
+    const auto& series = syntheticSeries(state.range(0));
+    size_t window_size = static_cast<size_t>(state.range(1));
+    for (auto _ : state) {
+        std::deque<double> window;
+        double sink = 0.0;
+        for (double v : series) sink += naiveTick(window, window_size, v);
+        doNotOptimize(sink);
+    }
+    state.setRowsPerIteration(series.size());
+}
+
+BENCHMARK(BM_RollingStats)->argNames({"n", "window"})->argsProduct({{10000, 1000000}, {30, 250, 1000, 5000}});
+BENCHMARK(BM_RollingStatsFixed30)->argNames({"n"})->args({10000})->args({1000000});
+BENCHMARK(BM_RollingStatsNaive)->argNames({"n", "window"})->argsProduct({{100000}, {30, 250, 1000}});
+
+// === Sliding-window detector ===
+
+static void runSlidingWindow(BenchState& state, bool real, bool batch) {
+    const std::vector<double>* series = seriesFor(state, real);
+    if (!series) return;
+    int window_size = static_cast<int>(state.range(real ? 0 : 1));
+    for (auto _ : state) {
+        auto anomalies = batch ? detectAnomaliesSlidingWindowBatch(*series, window_size, 2.5)
+                               : detectAnomaliesSlidingWindow(*series, window_size, 2.5);
+        doNotOptimize(anomalies.data());
+    }
+    state.setRowsPerIteration(series->size());
+}
+
+static void BM_SlidingWindow(BenchState& state) { runSlidingWindow(state, false, false); }
+static void BM_SlidingWindowBatch(BenchState& state) { runSlidingWindow(state, false, true); }
+static void BM_SlidingWindow_Real(BenchState& state) { runSlidingWindow(state, true, false); }
+static void BM_SlidingWindowBatch_Real(BenchState& state) { runSlidingWindow(state, true, true); }
+
+BENCHMARK(BM_SlidingWindow)->argNames({"n", "window"})->argsProduct({{10000, 1000000}, {30, 250}});
+BENCHMARK(BM_SlidingWindowBatch)->argNames({"n", "window"})->argsProduct({{10000, 1000000}, {30, 250}});
+BENCHMARK(BM_SlidingWindow_Real)->argNames({"window"})->args({30})->args({250});
+BENCHMARK(BM_SlidingWindowBatch_Real)->argNames({"window"})->args({30})->args({250});
+
+// === Rolling median/MAD (Hampel) detector ===
+
+static void runHampel(BenchState& state, bool real) {
+    const std::vector<double>* series = seriesFor(state, real);
+    if (!series) return;
+    int window_size = static_cast<int>(state.range(real ? 0 : 1));
+    for (auto _ : state) {
+        auto anomalies = detectAnomaliesHampel(*series, window_size, 3.5);
+        doNotOptimize(anomalies.data());
+    }
+    state.setRowsPerIteration(series->size());
+}
+
+// Reference: computeMedianMAD over every full window, as the rolling structure replaces
+static void BM_HampelNaive(BenchState& state) {
+    const auto& series = syntheticSeries(state.range(0));
+    size_t window_size = static_cast<size_t>(state.range(1));
+    std::vector<double> scratch;
+    for (auto _ : state) {
+        double sink = 0.0;
+        for (size_t i = window_size; i <= series.size(); ++i) {
+            RobustStats stats = computeMedianMAD(std::span<const double>(series).subspan(i - window_size, window_size),
+                                                 scratch);
+            sink += stats.median + stats.mad;
+        }
+        doNotOptimize(sink);
+    }
+    state.setRowsPerIteration(series.size());
+}
+
+static void BM_Hampel(BenchState& state) { runHampel(state, false); }
+static void BM_Hampel_Real(BenchState& state) { runHampel(state, true); }
+
+BENCHMARK(BM_Hampel)->argNames({"n", "window"})->argsProduct({{10000, 1000000}, {30, 250, 1000}});
+BENCHMARK(BM_HampelNaive)->argNames({"n", "window"})->argsProduct({{100000}, {30, 250, 1000}});
+BENCHMARK(BM_Hampel_Real)->argNames({"window"})->args({30})->args({250});
+
+// === Heap detector and granular threshold search ===
+
+enum class HeapVariant { Fixed, Granular, Quantile };
+
+static void runHeap(BenchState& state, bool real, HeapVariant variant) {
+    const std::vector<double>* series = seriesFor(state, real);
+    if (!series) return;
+    for (auto _ : state) {
+        switch (variant) {
+            case HeapVariant::Fixed:
+                doNotOptimize(detectAnomaliesHeap(*series, 3.0).data());
+                break;
+            case HeapVariant::Granular:
+                doNotOptimize(detectAnomaliesHeapGranular(*series, 0.035).data());
+                break;
+            case HeapVariant::Quantile:
+                doNotOptimize(detectAnomaliesHeapQuantile(*series, 0.035).anomalies.data());
+                break;
+        }
+    }
+    state.setRowsPerIteration(series->size());
+}
+
+static void BM_Heap(BenchState& state) { runHeap(state, false, HeapVariant::Fixed); }
+static void BM_HeapGranular(BenchState& state) { runHeap(state, false, HeapVariant::Granular); }
+static void BM_HeapQuantile(BenchState& state) { runHeap(state, false, HeapVariant::Quantile); }
+static void BM_Heap_Real(BenchState& state) { runHeap(state, true, HeapVariant::Fixed); }
+static void BM_HeapGranular_Real(BenchState& state) { runHeap(state, true, HeapVariant::Granular); }
+static void BM_HeapQuantile_Real(BenchState& state) { runHeap(state, true, HeapVariant::Quantile); }
+
+BENCHMARK(BM_Heap)->argNames({"n"})->args({10000})->args({1000000});
+BENCHMARK(BM_HeapGranular)->argNames({"n"})->args({10000})->args({1000000});
+BENCHMARK(BM_HeapQuantile)->argNames({"n"})->args({10000})->args({1000000});
+BENCHMARK(BM_Heap_Real);
+BENCHMARK(BM_HeapGranular_Real);
+BENCHMARK(BM_HeapQuantile_Real);
+
+// === Anomaly output: one "index,daily_return,anomaly" line per row ===
+
+static void runWriteFlags(BenchState& state, bool buffered) {
+    const auto& series = syntheticSeries(state.range(0));
+    std::string filename = (std::filesystem::temp_directory_path() / "project3_bench_flags.csv").string();
+    for (auto _ : state) {
+        if (buffered) {
+            BufferedWriter out(filename);
+            out.write("index,daily_return,anomaly\n");
+            for (size_t i = 0; i < series.size(); ++i) {
+                out.writeInt(static_cast<int64_t>(i));
+                out.put(',');
+                out.writeDouble(series[i]);
+                out.write(std::abs(series[i]) > 0.03 ? ",1\n" : ",0\n");
+            }
+            if (!out.close()) state.skipWithError("could not write " + filename);
+        } else {
+            std::ofstream out(filename);
+            out << "index,daily_return,anomaly\n";
+            for (size_t i = 0; i < series.size(); ++i) {
+                out << i << ',' << series[i] << ',' << (std::abs(series[i]) > 0.03 ? 1 : 0) << '\n';
+            }
+            out.close();
+            if (!out) state.skipWithError("could not write " + filename);
+        }
+    }
+    std::filesystem::remove(filename);
+    state.setRowsPerIteration(series.size());
+}
+
+static void BM_WriteFlagsStream(BenchState& state) { runWriteFlags(state, false); }
+static void BM_WriteFlagsBuffered(BenchState& state) { runWriteFlags(state, true); }
+
+BENCHMARK(BM_WriteFlagsStream)->argNames({"n"})->args({100000})->args({10000000});
+BENCHMARK(BM_WriteFlagsBuffered)->argNames({"n"})->args({100000})->args({10000000});
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--data=")) g_data_filename = arg.substr(7);
+    }
+
+    int result = runBenchmarks(argc, argv);
+    removeSyntheticCsvs();
+    return result;
+}
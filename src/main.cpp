@@ -1,20 +1,26 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <fstream>
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
-#include <set>
 #include <numeric>
+#include <span>
 
+#include "utils/anomaly_mask.h"
+#include "utils/buffered_writer.h"
 #include "utils/csv_utils.h"
+#include "utils/feature_engineering.h"
+#include "utils/phase_timer.h"
 #include "utils/rolling_stats.h"
+#include "utils/ticker_partition.h"
 #include "algs/anomaly_sliding_window.h"
 #include "algs/anomaly_heap.h"
+#include "algs/parallel_detection.h"
 
 
-void printDataAnalysis(const std::vector<double>& data) {
+void printDataAnalysis(std::span<const double> data) {
+    PROFILE_PHASE_ROWS("data analysis", data.size());
     if (data.empty()) return;
     
     auto minmax = std::minmax_element(data.begin(), data.end());
@@ -64,36 +70,41 @@ void printDataAnalysis(const std::vector<double>& data) {
 
 void saveAnomalies(const std::vector<int>& anomalies, const std::string& filename, 
                    const std::string& method) {
-    std::ofstream file(filename);
+    PROFILE_PHASE_ROWS("save anomalies", anomalies.size());
+    BufferedWriter file(filename);
     if (!file.is_open()) {
         std::cerr << "Error: Could not open " << filename << " for writing" << std::endl;
         return;
     }
     
-    file << "index,method" << std::endl;
+    file.write("index,method\n");
     for (int idx : anomalies) {
-        file << idx << "," << method << std::endl;
+        file.writeInt(idx);
+        file.put(',');
+        file.write(method);
+        file.put('\n');
+    }
+    if (!file.close()) {
+        std::cerr << "Error: Could not write " << filename << std::endl;
+        return;
     }
-    file.close();
     std::cout << "• " << filename << std::endl;
 }
 
-void printSummary(const std::vector<double>& data, 
+void printSummary(std::span<const double> data, 
                   const std::vector<int>& sliding_anomalies,
                   const std::vector<int>& heap_anomalies) {
+    PROFILE_PHASE("summary");
     
-    // Calculate overlap
-    std::set<int> sliding_set(sliding_anomalies.begin(), sliding_anomalies.end());
-    std::set<int> heap_set(heap_anomalies.begin(), heap_anomalies.end());
-    
-    std::vector<int> overlap;
-    std::set_intersection(sliding_set.begin(), sliding_set.end(),
-                         heap_set.begin(), heap_set.end(),
-                         std::back_inserter(overlap));
+    // Calculate overlap on bit masks (one bit per row)
+    AnomalyMask sliding_mask = AnomalyMask::fromIndices<int>(sliding_anomalies, data.size());
+    AnomalyMask heap_mask = AnomalyMask::fromIndices<int>(heap_anomalies, data.size());
+    uint64_t overlap = countOverlap(sliding_mask, heap_mask);
+    uint64_t disagreement = countDisagreement(sliding_mask, heap_mask);
     
     double sliding_pct = (double)sliding_anomalies.size() / data.size() * 100;
     double heap_pct = (double)heap_anomalies.size() / data.size() * 100;
-    double overlap_pct = (double)overlap.size() / data.size() * 100;
+    double overlap_pct = (double)overlap / data.size() * 100;
     
     std::cout << "===================================================" << std::endl;
     std::cout << "FINAL RESULTS SUMMARY" << std::endl;
@@ -103,8 +114,9 @@ void printSummary(const std::vector<double>& data,
               << " (" << std::fixed << std::setprecision(5) << sliding_pct << "%)" << std::endl;
     std::cout << "🔍 Heap-based anomalies: " << heap_anomalies.size() 
               << " (" << heap_pct << "%)" << std::endl;
-    std::cout << "🔄 Overlapping anomalies: " << overlap.size() 
+    std::cout << "🔄 Overlapping anomalies: " << overlap 
               << " (" << overlap_pct << "%)" << std::endl;
+    std::cout << "↔️  Flagged by only one method: " << disagreement << std::endl;
     
     std::cout << "🔍 DETECTION QUALITY ASSESSMENT:" << std::endl;
     if (sliding_pct >= 2.0 && sliding_pct <= 5.0) {
@@ -128,16 +140,19 @@ void printSummary(const std::vector<double>& data,
 
 int main() {
     // Load data
-    std::string filename = "../data/features.csv";
-    std::vector<double> data;
+    std::string filename = "../data/stock_data.csv";
+    FeatureTable table;
     
     std::cout << "Loading data from " << filename << "..." << std::endl;
     
-    // Try to load the CSV file
-    if (!loadCSV(filename, data)) {
+    // Load raw prices and compute the features in memory (what preprocess_features.py
+    // used to write to features.csv). Later runs read the prices from the binary cache
+    // next to the CSV until it changes.
+    if (!buildFeatureTable(filename, table) || table.size() == 0) {
         std::cerr << "Failed to load data from " << filename << std::endl;
         return 1;
     }
+    std::span<const double> data = table.column(FeatureColumn::DailyReturn);
     
     std::cout << "Loaded " << data.size() << " rows from " << filename << std::endl << std::endl;
     
@@ -148,22 +163,52 @@ int main() {
     std::cout << "=== SLIDING WINDOW DETECTION ===" << std::endl;
     int window_size = 30;
     double threshold_std = 2.5;
+    bool per_ticker = true; // keep each window within a single stock
+    unsigned num_threads = 0; // 0 = one worker per hardware thread
     
     std::cout << "Window size: " << window_size << std::endl;
     std::cout << "Threshold: " << threshold_std << " standard deviations" << std::endl;
     
-    auto sliding_anomalies = detectAnomaliesSlidingWindow(data, window_size, threshold_std);
+    auto partitions = partitionByTicker(table, FeatureColumn::DailyReturn);
+    WorkStealingPool pool(num_threads);
+    
+    std::vector<int> sliding_anomalies;
+    if (per_ticker) {
+        std::cout << "Mode: per-ticker (" << partitions.size() << " tickers, "
+                  << pool.size() << " threads)" << std::endl;
+        sliding_anomalies = detectAnomaliesSlidingWindowParallel(partitions, window_size, threshold_std, pool);
+    } else {
+        std::cout << "Mode: whole table" << std::endl;
+        sliding_anomalies = detectAnomaliesSlidingWindow(data, window_size, threshold_std);
+    }
     
     double sliding_percentage = (double)sliding_anomalies.size() / data.size() * 100;
     std::cout << "✅ Sliding window anomalies detected: " << sliding_anomalies.size() 
               << " (" << std::fixed << std::setprecision(5) << sliding_percentage << "%)" << std::endl << std::endl;
     
+    // === ROLLING MEDIAN/MAD (HAMPEL) DETECTION ===
+    std::cout << "=== ROLLING MEDIAN/MAD (HAMPEL) DETECTION ===" << std::endl;
+    double hampel_threshold = 3.5;
+    std::cout << "Window size: " << window_size << std::endl;
+    std::cout << "Threshold: " << hampel_threshold << " robust standard deviations" << std::endl;
+    
+    auto hampel_anomalies = detectAnomaliesHampelParallel(partitions, window_size, hampel_threshold, pool);
+    
+    double hampel_percentage = (double)hampel_anomalies.size() / data.size() * 100;
+    std::cout << "✅ Hampel anomalies detected: " << hampel_anomalies.size() 
+              << " (" << std::fixed << std::setprecision(5) << hampel_percentage << "%)" << std::endl << std::endl;
+    
     // === IMPROVED HEAP-BASED DETECTION ===
     std::cout << "=== IMPROVED HEAP-BASED DETECTION ===" << std::endl;
     
-    // Use the granular search with a target of ~3-4% (similar to sliding window)
+    // Flag the target share of points directly from the robust z-score quantile
     double target_rate = 0.035; // 3.5% target
-    auto heap_anomalies = detectAnomaliesHeapGranular(data, target_rate);
+    std::cout << "Target anomaly rate: " << (target_rate * 100) << "%" << std::endl;
+    auto heap_result = detectAnomaliesHeapQuantile(data, target_rate);
+    auto& heap_anomalies = heap_result.anomalies;
+    std::cout << "Median: " << std::fixed << std::setprecision(6) << heap_result.median
+              << ", Robust STD: " << heap_result.robust_std << std::endl;
+    std::cout << "Implied threshold: " << heap_result.threshold << " robust standard deviations" << std::endl;
     
     double heap_percentage = (double)heap_anomalies.size() / data.size() * 100;
     std::cout << "Final heap detection rate: " << heap_percentage << "%" << std::endl << std::endl;
@@ -174,9 +219,13 @@ int main() {
     // Save results
     saveAnomalies(sliding_anomalies, "../output/sliding_anomalies.csv", "sliding_window");
     saveAnomalies(heap_anomalies, "../output/heap_anomalies.csv", "heap_based");
+    saveAnomalies(hampel_anomalies, "../output/hampel_anomalies.csv", "hampel");
     
     std::cout << "===================================================" << std::endl;
     
+    // Phase timings as JSON; only written when built with PROJECT3_PROFILE
+    PROFILE_REPORT("../output/run_report.json", data.size());
+    
     return 0;
 }
 
@@ -0,0 +1,82 @@
+// Replays features.csv tick by tick through StreamingSlidingWindowDetector and
+// checks that it flags exactly the rows the batch per-ticker detector flags. Then
+// streams the returns through StreamingHeapDetector and checks its sketch median/MAD
+// against the exact batch values and the sketch's error bound.
+// Usage: Project3_replay [features.csv] [window_size] [threshold]
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../utils/csv_utils.h"
+#include "../utils/robust_stats.h"
+#include "../utils/ticker_partition.h"
+#include "../algs/anomaly_sliding_window.h"
+#include "../algs/streaming_detector.h"
+
+int main(int argc, char** argv) {
+    std::string filename = argc > 1 ? argv[1] : "../data/features.csv";
+    int window_size = argc > 2 ? std::stoi(argv[2]) : 30;
+    double threshold = argc > 3 ? std::stod(argv[3]) : 2.5;
+
+    FeatureTable table;
+    if (!read_feature_table(filename, table, {FeatureColumn::DailyReturn}) || table.size() == 0) {
+        std::cerr << "Failed to load data from " << filename << std::endl;
+        return 1;
+    }
+
+    auto batch = detectAnomaliesSlidingWindowByTicker(
+        partitionByTicker(table, FeatureColumn::DailyReturn), window_size, threshold);
+
+    StreamingSlidingWindowDetector detector(window_size, threshold);
+    std::vector<int> streamed;
+    size_t out_of_order = 0;
+    for (size_t i = 0; i < table.size(); ++i) {
+        auto verdict = detector.push(table.tickerName(i), table.dates[i], table.daily_return[i]);
+        if (verdict.isAnomaly()) {
+            streamed.push_back(static_cast<int>(i));
+        } else if (verdict.status == StreamVerdict::Status::OutOfOrder) {
+            ++out_of_order;
+        }
+    }
+
+    std::cout << "Replayed " << table.size() << " ticks across " << detector.tickerCount() << " tickers" << std::endl;
+    std::cout << "Batch anomalies: " << batch.size() << ", streamed anomalies: " << streamed.size() << std::endl;
+    if (out_of_order > 0) {
+        std::cout << "Out-of-order ticks ignored: " << out_of_order << std::endl;
+    }
+
+    if (streamed != batch) {
+        size_t i = 0;
+        while (i < batch.size() && i < streamed.size() && batch[i] == streamed[i]) ++i;
+        std::cerr << "MISMATCH: first difference at position " << i << std::endl;
+        return 1;
+    }
+
+    std::cout << "Streaming results match batch detection" << std::endl;
+
+    // Robust statistics: sketch estimates against the exact batch median/MAD
+    StreamingHeapDetector heap_detector(threshold);
+    size_t heap_flags = 0;
+    for (double value : table.daily_return) {
+        heap_flags += heap_detector.push(value).isAnomaly();
+    }
+    RobustStats exact = computeMedianMAD(table.daily_return);
+    RobustStats approx = heap_detector.sketch().stats();
+    double alpha = 0.01;
+    double median_bound = alpha * std::abs(exact.median);
+    double mad_bound = alpha * (2.0 * std::abs(exact.median) + exact.mad);
+
+    std::cout << "Streaming robust stats (" << heap_detector.sketch().bucketCount() << " buckets): "
+              << "median " << approx.median << " vs " << exact.median
+              << ", MAD " << approx.mad << " vs " << exact.mad << std::endl;
+    std::cout << "Streaming heap detector flagged " << heap_flags << " ticks" << std::endl;
+
+    if (std::abs(approx.median - exact.median) > median_bound ||
+        std::abs(approx.mad - exact.mad) > mad_bound) {
+        std::cerr << "MISMATCH: sketch error exceeds its documented bound" << std::endl;
+        return 1;
+    }
+    std::cout << "Sketch median/MAD within the documented error bound" << std::endl;
+    return 0;
+}
@@ -0,0 +1,365 @@
+// Randomized consistency checks for the incremental data structures and fast detector
+// paths against simple reference implementations. Prints one line per check and exits
+// non-zero on the first mismatch, so it can run under ctest.
+// Usage: Project3_check [seed]
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../utils/anomaly_mask.h"
+#include "../utils/cpu_features.h"
+#include "../utils/prefix_moments.h"
+#include "../utils/robust_stats.h"
+#include "../algs/anomaly_heap.h"
+#include "../algs/anomaly_sliding_window.h"
+#include "../algs/sliding_window_kernel.h"
+
+namespace {
+
+bool fail(const std::string& check, const std::string& detail) {
+    std::cerr << "MISMATCH in " << check << ": " << detail << std::endl;
+    return false;
+}
+
+// RollingMedianMAD against computeMedianMAD over the last W non-NaN values, for W from
+// 1 to 100 (sorted-array windows) and one tree-backed window. Values are drawn from a
+// small grid so ties are common, with NaNs mixed in.
+bool checkRollingMedianMAD(std::mt19937_64& rng) {
+    std::uniform_int_distribution<int> grid(-20, 20);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    for (int window_size = 1; window_size <= 100; ++window_size) {
+        RollingMedianMAD rolling(window_size);
+        std::vector<double> finite;
+        for (int i = 0; i < 5 * window_size + 50; ++i) {
+            double value = unit(rng) < 0.05 ? nan : grid(rng) * 0.25;
+            rolling.add(value);
+            if (std::isnan(value)) continue;
+            finite.push_back(value);
+
+            size_t n = std::min(finite.size(), static_cast<size_t>(window_size));
+            if (rolling.ready() != (n == static_cast<size_t>(window_size))) {
+                return fail("RollingMedianMAD", "ready() wrong at W=" + std::to_string(window_size));
+            }
+            RobustStats expected = computeMedianMAD(std::span<const double>(finite).last(n));
+            RobustStats actual = rolling.stats();
+            if (actual.median != expected.median || actual.mad != expected.mad) {
+                return fail("RollingMedianMAD", "W=" + std::to_string(window_size) + " step " + std::to_string(i) +
+                            ": median/MAD " + std::to_string(actual.median) + "/" + std::to_string(actual.mad) +
+                            ", expected " + std::to_string(expected.median) + "/" + std::to_string(expected.mad));
+            }
+        }
+    }
+
+    // Windows too large for the sorted array use the tree; spot-check one after it fills
+    {
+        int window_size = static_cast<int>(RollingMedianMAD::kSortedArrayMax) + 1;
+        RollingMedianMAD rolling(window_size);
+        std::vector<double> finite;
+        for (int i = 0; i < window_size + 2000; ++i) {
+            double value = unit(rng) < 0.05 ? nan : grid(rng) * 0.25;
+            rolling.add(value);
+            if (std::isnan(value)) continue;
+            finite.push_back(value);
+            if (finite.size() < static_cast<size_t>(window_size) || i % 97 != 0) continue;
+
+            RobustStats expected = computeMedianMAD(std::span<const double>(finite).last(window_size));
+            RobustStats actual = rolling.stats();
+            if (!rolling.ready() || actual.median != expected.median || actual.mad != expected.mad) {
+                return fail("RollingMedianMAD", "tree-backed W=" + std::to_string(window_size) + " step " +
+                            std::to_string(i) + " differs from batch median/MAD");
+            }
+        }
+    }
+
+    // A non-positive window behaves as a window of one
+    RollingMedianMAD degenerate(0);
+    degenerate.add(3.0);
+    degenerate.add(5.0);
+    if (!degenerate.ready() || degenerate.median() != 5.0 || degenerate.mad() != 0.0) {
+        return fail("RollingMedianMAD", "window_size 0 is not treated as 1");
+    }
+
+    std::cout << "RollingMedianMAD matches batch median/MAD for W = 1..100 and "
+              << RollingMedianMAD::kSortedArrayMax + 1 << std::endl;
+    return true;
+}
+
+// Mean and population stddev of series[begin, end), two-pass in long double
+void exactMoments(std::span<const double> series, size_t begin, size_t end, double& mean, double& stddev) {
+    long double m = 0.0L;
+    for (size_t j = begin; j < end; ++j) m += series[j];
+    m /= static_cast<long double>(end - begin);
+    long double q = 0.0L;
+    for (size_t j = begin; j < end; ++j) q += (series[j] - m) * (series[j] - m);
+    mean = static_cast<double>(m);
+    stddev = static_cast<double>(std::sqrt(q / static_cast<long double>(end - begin)));
+}
+
+// PrefixMoments windows against exact moments on a long series with a level shift
+// halfway through, where sums from the start of the series would lose ~1e-6 relative
+bool checkPrefixMoments(std::mt19937_64& rng) {
+    const size_t n = 20'000'000;
+    std::normal_distribution<double> noise(0.0, 0.01);
+    std::vector<double> series(n);
+    for (size_t i = 0; i < n; ++i) {
+        series[i] = 100.0 + (i >= n / 2 ? 5.0 : 0.0) + noise(rng);
+    }
+    PrefixMoments moments(series);
+
+    // Variance of each prefix block about its own mean (its shift)
+    std::vector<double> block_variance;
+    for (size_t begin = 0; begin < n; begin += PrefixMoments::kBlockSize) {
+        size_t end = std::min(n, begin + PrefixMoments::kBlockSize);
+        double mean, stddev;
+        exactMoments(series, begin, end, mean, stddev);
+        block_variance.push_back(stddev * stddev);
+    }
+
+    // The documented bound, eps * (block + W) / W * s^2 absolute on the variance, with a
+    // constant factor of slack; worst is the largest error / bound seen
+    double worst = 0.0;
+    auto compare = [&](size_t begin, size_t end) {
+        double mean, stddev, exact_mean, exact_stddev;
+        moments.window(begin, end, mean, stddev);
+        exactMoments(series, begin, end, exact_mean, exact_stddev);
+
+        size_t last_block = (end - 1) / PrefixMoments::kBlockSize;
+        double shift = moments.blockShift(last_block);
+        double spread = 0.0;
+        for (size_t b = begin / PrefixMoments::kBlockSize; b <= last_block; ++b) {
+            double d = moments.blockShift(b) - shift;
+            spread = std::max(spread, block_variance[b] + d * d);
+        }
+        double w = static_cast<double>(end - begin);
+        double bound = 16.0 * std::numeric_limits<double>::epsilon() *
+                       (PrefixMoments::kBlockSize + w) / w * spread;
+        double ratio = std::abs(stddev * stddev - exact_stddev * exact_stddev) / bound;
+        worst = std::max(worst, ratio);
+        return ratio <= 1.0 && std::abs(mean - exact_mean) <= 1e-12 * std::abs(exact_mean);
+    };
+
+    // W = 30 windows at the end of the series, well after the level shift
+    for (size_t end = n - 999; end <= n; ++end) {
+        if (!compare(end - 30, end)) {
+            return fail("PrefixMoments", "W=30 window ending at " + std::to_string(end) +
+                        " outside the error bound");
+        }
+    }
+    // Windows anywhere, including ones spanning several prefix blocks and the shift
+    std::uniform_int_distribution<size_t> position(0, n);
+    for (size_t window : {2, 7, 30, 4095, 4096, 4097, 10000}) {
+        for (int k = 0; k < 200; ++k) {
+            size_t end = std::max(position(rng), window);
+            if (!compare(end - window, end)) {
+                return fail("PrefixMoments", "W=" + std::to_string(window) + " window ending at " +
+                            std::to_string(end) + " outside the error bound");
+            }
+        }
+    }
+    std::cout << "PrefixMoments within its error bound on " << n << " rows (worst error "
+              << worst << " of the bound)" << std::endl;
+
+    return true;
+}
+
+// slidingWindowMask at every SIMD level against exact long-double verdicts and against
+// detectAnomaliesSlidingWindow, on a series with fat-tailed jumps (so plenty of points
+// flag) and a level shift. Points may only differ inside the tolerance documented in
+// sliding_window_kernel.h: the kernel's prefix-sum bound, plus 1e-9 * stddev for
+// RollingStats when comparing with the stateful path.
+bool checkSlidingWindowMask(std::mt19937_64& rng) {
+    const size_t n = 100'000;
+    std::normal_distribution<double> noise(0.0, 0.01);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<double> series(n);
+    for (size_t i = 0; i < n; ++i) {
+        series[i] = 100.0 + (i >= n / 2 ? 5.0 : 0.0) + noise(rng);
+        if (unit(rng) < 0.01) series[i] += 0.05 * (unit(rng) - 0.5);
+    }
+
+    const double threshold = 2.5;
+    const double eps = std::numeric_limits<double>::epsilon();
+    SimdLevel supported = detectSimdLevel();
+    for (int window_size : {5, 30, 250, 5000}) {
+        size_t window = static_cast<size_t>(window_size);
+        size_t block = slidingWindowBlockSize(window_size);
+
+        // Variance of each block's span, [m * block, (m + 1) * block + window - 1)
+        std::vector<double> span_variance;
+        for (size_t begin = 0; begin + window - 1 < n; begin += block) {
+            double mean, stddev;
+            exactMoments(series, begin, std::min(n, begin + block + window - 1), mean, stddev);
+            span_variance.push_back(stddev * stddev);
+        }
+
+        AnomalyMask expected(n), kernel_uncertain(n), stateful_uncertain(n);
+        for (size_t i = window - 1; i < n; ++i) {
+            double mean, stddev;
+            exactMoments(series, i + 1 - window, i + 1, mean, stddev);
+            double margin = std::abs(series[i] - mean) - threshold * stddev;
+            if (margin > 0) expected.set(i);
+
+            size_t begin = (i + 1 - window) / block * block;
+            double span = static_cast<double>(std::min(n, begin + block + window - 1) - begin);
+            double s2 = span_variance[begin / block];
+            double tolerance = eps * span * span / window * (std::sqrt(s2) + threshold * s2 / stddev);
+            if (std::abs(margin) <= tolerance) kernel_uncertain.set(i);
+            if (std::abs(margin) <= tolerance + 1e-9 * stddev) stateful_uncertain.set(i);
+        }
+
+        AnomalyMask stateful(n);
+        for (int row : detectAnomaliesSlidingWindow(series, window_size, threshold)) stateful.set(row);
+
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+            if (level > supported) continue;
+            AnomalyMask actual = slidingWindowMask(series, window_size, threshold, level);
+            std::string where = std::string(simdLevelName(level)) + " W=" + std::to_string(window_size);
+
+            size_t differing = 0;
+            (actual ^ expected).forEach([&](uint64_t row) { differing += !kernel_uncertain.test(row); });
+            if (differing != 0) {
+                return fail("slidingWindowMask", where + ": " + std::to_string(differing) +
+                            " verdicts differ from exact moments");
+            }
+            differing = 0;
+            (actual ^ stateful).forEach([&](uint64_t row) { differing += !stateful_uncertain.test(row); });
+            if (differing != 0) {
+                return fail("slidingWindowMask", where + ": " + std::to_string(differing) +
+                            " verdicts differ from detectAnomaliesSlidingWindow");
+            }
+        }
+    }
+    std::cout << "slidingWindowMask matches exact verdicts and detectAnomaliesSlidingWindow up to "
+              << simdLevelName(supported) << std::endl;
+    return true;
+}
+
+// AnomalyMask &, |, ^, count, toIndices and the overlap/disagreement counts against a
+// byte-per-row reference, at every SIMD level the CPU has, for sizes around word and
+// vector boundaries and for operands of different lengths
+bool checkAnomalyMask(std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    auto randomFlags = [&](size_t rows) {
+        std::vector<uint8_t> flags(rows);
+        double density = unit(rng);
+        for (uint8_t& flag : flags) flag = unit(rng) < density;
+        return flags;
+    };
+    auto expectedIndices = [](const std::vector<uint8_t>& flags) {
+        std::vector<uint64_t> indices;
+        for (size_t i = 0; i < flags.size(); ++i) {
+            if (flags[i]) indices.push_back(i);
+        }
+        return indices;
+    };
+
+    const size_t sizes[] = {0, 1, 10, 60, 63, 64, 65, 127, 128, 255, 511, 512, 513, 1000, 4097};
+    SimdLevel supported = detectSimdLevel();
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level > supported) continue;
+        limitSimdLevel(level);
+        std::string where = std::string(simdLevelName(level));
+
+        for (size_t rows_a : sizes) {
+            for (size_t rows_b : sizes) {
+                auto flags_a = randomFlags(rows_a);
+                auto flags_b = randomFlags(rows_b);
+                AnomalyMask a = AnomalyMask::fromBytes(flags_a);
+                AnomalyMask b = AnomalyMask::fromBytes(flags_b);
+                std::string shape = where + " " + std::to_string(rows_a) + " vs " + std::to_string(rows_b) + " rows";
+
+                size_t overlap = 0, disagreement = 0;
+                std::vector<uint8_t> expected_and(rows_a), expected_or(rows_a), expected_xor(rows_a);
+                for (size_t i = 0; i < std::max(rows_a, rows_b); ++i) {
+                    bool in_a = i < rows_a && flags_a[i];
+                    bool in_b = i < rows_b && flags_b[i];
+                    overlap += in_a && in_b;
+                    disagreement += in_a != in_b;
+                    if (i < rows_a) {
+                        expected_and[i] = in_a && in_b;
+                        expected_or[i] = in_a || in_b;
+                        expected_xor[i] = in_a != in_b;
+                    }
+                }
+
+                if (a.count() != expectedIndices(flags_a).size() || a.toIndices() != expectedIndices(flags_a)) {
+                    return fail("AnomalyMask", shape + ": count/toIndices");
+                }
+                if (countOverlap(a, b) != overlap || countDisagreement(a, b) != disagreement) {
+                    return fail("AnomalyMask", shape + ": countOverlap/countDisagreement");
+                }
+                struct Case { const char* name; AnomalyMask result; const std::vector<uint8_t>& expected; };
+                for (const Case& c : {Case{"&", a & b, expected_and}, Case{"|", a | b, expected_or},
+                                      Case{"^", a ^ b, expected_xor}}) {
+                    auto indices = expectedIndices(c.expected);
+                    if (c.result.size() != rows_a || c.result.count() != indices.size() ||
+                        c.result.toIndices() != indices) {
+                        return fail("AnomalyMask", shape + ": operator" + c.name);
+                    }
+                }
+            }
+        }
+    }
+    limitSimdLevel(SimdLevel::AVX512);
+
+    std::cout << "AnomalyMask matches a byte-per-row reference up to " << simdLevelName(supported) << std::endl;
+    return true;
+}
+
+// detectAnomaliesHeap against HeapThresholdSweep::anomaliesAt on tie-heavy data, where
+// equal deviations straddle the 5% cap and the two must keep the same rows
+bool checkHeapSweep(std::mt19937_64& rng) {
+    std::vector<std::vector<double>> cases;
+
+    // 80 small values, then 19 equal outliers competing for 4 slots behind one larger one
+    std::vector<double> straddle;
+    for (int i = 0; i < 80; ++i) straddle.push_back(0.001 * (i % 7));
+    straddle.insert(straddle.end(), 19, 1.0);
+    straddle.push_back(2.0);
+    cases.push_back(straddle);
+
+    std::uniform_int_distribution<int> grid(-6, 6);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t n : {20, 100, 101, 1000, 5000}) {
+        for (int k = 0; k < 20; ++k) {
+            // Mostly a tight cluster with a few large, heavily repeated values
+            std::vector<double> data(n);
+            for (double& value : data) value = unit(rng) < 0.15 ? grid(rng) : grid(rng) * 0.01;
+            cases.push_back(std::move(data));
+        }
+    }
+
+    for (const auto& data : cases) {
+        HeapThresholdSweep sweep(data);
+        for (double threshold = 0.5; threshold <= 6.0; threshold += 0.25) {
+            if (detectAnomaliesHeap(data, threshold) != sweep.anomaliesAt(threshold)) {
+                return fail("HeapThresholdSweep", std::to_string(data.size()) + " rows, threshold " +
+                            std::to_string(threshold) + ": selects different rows than detectAnomaliesHeap");
+            }
+        }
+    }
+    std::cout << "HeapThresholdSweep matches detectAnomaliesHeap on tie-heavy data" << std::endl;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t seed = argc > 1 ? std::stoull(argv[1]) : 42;
+    std::mt19937_64 rng(seed);
+
+    bool ok = checkRollingMedianMAD(rng) &&
+              checkPrefixMoments(rng) &&
+              checkSlidingWindowMask(rng) &&
+              checkAnomalyMask(rng) &&
+              checkHeapSweep(rng);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+
+// Process-wide heap allocation counters. allocation_counter.cpp replaces the global
+// operator new/delete to feed them, so only executables that link that file count
+// allocations; the counters are relaxed atomics and cost one add per allocation.
+struct AllocationSnapshot {
+    uint64_t count = 0;  // operator new calls so far
+    uint64_t bytes = 0;  // bytes requested by those calls
+};
+
+AllocationSnapshot allocationSnapshot();
@@ -0,0 +1,175 @@
+#include "anomaly_mask.h"
+#include <algorithm>
+#include "cpu_features.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ANOMALY_MASK_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TARGET_AVX2
+#define TARGET_AVX512
+#define TARGET_POPCNT
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#define TARGET_POPCNT __attribute__((target("popcnt")))
+#endif
+#endif
+
+namespace {
+
+enum class BitOp { And, Or, Xor };
+
+template <BitOp Op>
+uint64_t apply(uint64_t a, uint64_t b) {
+    if constexpr (Op == BitOp::And) return a & b;
+    else if constexpr (Op == BitOp::Or) return a | b;
+    else return a ^ b;
+}
+
+#ifdef ANOMALY_MASK_X86
+
+// The vector kernels return how many words they handled; the caller finishes the tail
+template <BitOp Op>
+TARGET_AVX2 size_t combineAvx2(uint64_t* dst, const uint64_t* src, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i r;
+        if constexpr (Op == BitOp::And) r = _mm256_and_si256(a, b);
+        else if constexpr (Op == BitOp::Or) r = _mm256_or_si256(a, b);
+        else r = _mm256_xor_si256(a, b);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), r);
+    }
+    return i;
+}
+
+template <BitOp Op>
+TARGET_AVX512 size_t combineAvx512(uint64_t* dst, const uint64_t* src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i a = _mm512_loadu_si512(dst + i);
+        __m512i b = _mm512_loadu_si512(src + i);
+        __m512i r;
+        if constexpr (Op == BitOp::And) r = _mm512_and_si512(a, b);
+        else if constexpr (Op == BitOp::Or) r = _mm512_or_si512(a, b);
+        else r = _mm512_xor_si512(a, b);
+        _mm512_storeu_si512(dst + i, r);
+    }
+    return i;
+}
+
+// Same loop as countPortable; the target attribute turns std::popcount into POPCNT
+template <BitOp Op>
+TARGET_POPCNT uint64_t countPopcnt(const uint64_t* a, const uint64_t* b, size_t n) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; ++i) total += std::popcount(apply<Op>(a[i], b[i]));
+    return total;
+}
+
+#endif // ANOMALY_MASK_X86
+
+template <BitOp Op>
+uint64_t countPortable(const uint64_t* a, const uint64_t* b, size_t n) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; ++i) total += std::popcount(apply<Op>(a[i], b[i]));
+    return total;
+}
+
+template <BitOp Op>
+void combineWords(uint64_t* dst, const uint64_t* src, size_t n) {
+    size_t i = 0;
+#ifdef ANOMALY_MASK_X86
+    SimdLevel level = detectSimdLevel();
+    if (level == SimdLevel::AVX512) {
+        i = combineAvx512<Op>(dst, src, n);
+    } else if (level == SimdLevel::AVX2) {
+        i = combineAvx2<Op>(dst, src, n);
+    }
+#endif
+    for (; i < n; ++i) dst[i] = apply<Op>(dst[i], src[i]);
+}
+
+template <BitOp Op>
+uint64_t countWords(const uint64_t* a, const uint64_t* b, size_t n) {
+#ifdef ANOMALY_MASK_X86
+    // Every AVX2-capable CPU also has POPCNT
+    if (detectSimdLevel() != SimdLevel::Scalar) return countPopcnt<Op>(a, b, n);
+#endif
+    return countPortable<Op>(a, b, n);
+}
+
+template <BitOp Op>
+void combine(std::vector<uint64_t>& dst, std::span<const uint64_t> src) {
+    size_t shared = std::min(dst.size(), src.size());
+    combineWords<Op>(dst.data(), src.data(), shared);
+    if constexpr (Op == BitOp::And) {
+        std::fill(dst.begin() + shared, dst.end(), 0);
+    }
+}
+
+} // namespace
+
+AnomalyMask::AnomalyMask(uint64_t rows) : rows(rows), bits((rows + 63) / 64, 0) {}
+
+AnomalyMask AnomalyMask::fromBytes(std::span<const uint8_t> flags) {
+    AnomalyMask mask(flags.size());
+    for (size_t i = 0; i < flags.size(); ++i) {
+        mask.bits[i / 64] |= uint64_t{flags[i] != 0} << (i % 64);
+    }
+    return mask;
+}
+
+void AnomalyMask::clear() {
+    std::fill(bits.begin(), bits.end(), 0);
+}
+
+void AnomalyMask::clearTail() {
+    if (rows % 64 != 0) bits.back() &= (uint64_t{1} << (rows % 64)) - 1;
+}
+
+uint64_t AnomalyMask::count() const {
+    // x | x == x, so the shared kernel counts a single mask too
+    return countWords<BitOp::Or>(bits.data(), bits.data(), bits.size());
+}
+
+std::vector<uint64_t> AnomalyMask::toIndices() const {
+    std::vector<uint64_t> indices;
+    indices.reserve(count());
+    forEach([&](uint64_t row) { indices.push_back(row); });
+    return indices;
+}
+
+AnomalyMask& AnomalyMask::operator&=(const AnomalyMask& other) {
+    combine<BitOp::And>(bits, other.bits);
+    clearTail();
+    return *this;
+}
+
+AnomalyMask& AnomalyMask::operator|=(const AnomalyMask& other) {
+    combine<BitOp::Or>(bits, other.bits);
+    clearTail();
+    return *this;
+}
+
+AnomalyMask& AnomalyMask::operator^=(const AnomalyMask& other) {
+    combine<BitOp::Xor>(bits, other.bits);
+    clearTail();
+    return *this;
+}
+
+uint64_t countOverlap(const AnomalyMask& a, const AnomalyMask& b) {
+    size_t shared = std::min(a.words().size(), b.words().size());
+    return countWords<BitOp::And>(a.words().data(), b.words().data(), shared);
+}
+
+uint64_t countDisagreement(const AnomalyMask& a, const AnomalyMask& b) {
+    size_t shared = std::min(a.words().size(), b.words().size());
+    uint64_t total = countWords<BitOp::Xor>(a.words().data(), b.words().data(), shared);
+    // Words only one mask has count as disagreement wherever they're set
+    for (auto words : {a.words(), b.words()}) {
+        for (size_t i = shared; i < words.size(); ++i) total += std::popcount(words[i]);
+    }
+    return total;
+}
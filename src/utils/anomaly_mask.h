@@ -0,0 +1,75 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// One bit per row, for storing and comparing detector output without index lists or
+// sets. Rows are addressed with 64-bit indices, counts use popcount, and &, |, ^ run
+// over whole words with AVX-512/AVX2 when the CPU has them. 100M rows fit in 12.5 MB.
+class AnomalyMask {
+public:
+    AnomalyMask() = default;
+    explicit AnomalyMask(uint64_t rows);
+
+    // Builds a mask from an ascending or unordered index list; indices >= rows are ignored
+    template <typename Index>
+    static AnomalyMask fromIndices(std::span<const Index> indices, uint64_t rows) {
+        AnomalyMask mask(rows);
+        for (Index index : indices) {
+            uint64_t row = static_cast<uint64_t>(index);
+            if (row < rows) mask.set(row);
+        }
+        return mask;
+    }
+
+    // Builds a mask from one byte per row (nonzero = flagged)
+    static AnomalyMask fromBytes(std::span<const uint8_t> flags);
+
+    uint64_t size() const { return rows; }
+    bool test(uint64_t row) const { return (bits[row / 64] >> (row % 64)) & 1u; }
+    void set(uint64_t row) { bits[row / 64] |= uint64_t{1} << (row % 64); }
+    void reset(uint64_t row) { bits[row / 64] &= ~(uint64_t{1} << (row % 64)); }
+    void clear();
+
+    // Number of flagged rows
+    uint64_t count() const;
+
+    // Calls fn(row) for every flagged row in ascending order
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (size_t w = 0; w < bits.size(); ++w) {
+            for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                fn(w * 64 + static_cast<uint64_t>(std::countr_zero(word)));
+            }
+        }
+    }
+
+    // Flagged rows as an ascending index list
+    std::vector<uint64_t> toIndices() const;
+
+    // Masks are expected to cover the same rows; a shorter operand acts as zero-padded,
+    // and rows of a longer operand past size() are dropped
+    AnomalyMask& operator&=(const AnomalyMask& other);
+    AnomalyMask& operator|=(const AnomalyMask& other);
+    AnomalyMask& operator^=(const AnomalyMask& other);
+
+    // Packed words, bit (row % 64) of word (row / 64); bits past size() are always 0
+    std::span<const uint64_t> words() const { return bits; }
+    std::span<uint64_t> mutableWords() { return bits; }
+
+private:
+    // Zeroes the bits past size() in the last word
+    void clearTail();
+
+    uint64_t rows = 0;
+    std::vector<uint64_t> bits;
+};
+
+inline AnomalyMask operator&(AnomalyMask a, const AnomalyMask& b) { return a &= b; }
+inline AnomalyMask operator|(AnomalyMask a, const AnomalyMask& b) { return a |= b; }
+inline AnomalyMask operator^(AnomalyMask a, const AnomalyMask& b) { return a ^= b; }
+
+// Rows flagged by both masks / by exactly one of them, counted without building a result mask
+uint64_t countOverlap(const AnomalyMask& a, const AnomalyMask& b);
+uint64_t countDisagreement(const AnomalyMask& a, const AnomalyMask& b);
@@ -0,0 +1,141 @@
+#include "buffered_writer.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Longest to_chars output for an int64 or a "%g" double with up to 17 digits
+static constexpr size_t kMaxNumberChars = 32;
+
+#ifdef _WIN32
+
+BufferedWriter::BufferedWriter(const std::string& filename, size_t buffer_size)
+    : buffer(std::max(buffer_size, kMaxNumberChars)) {
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_WRITE, 0, nullptr,
+                              CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file != INVALID_HANDLE_VALUE) file_handle = file;
+}
+
+bool BufferedWriter::is_open() const {
+    return file_handle != nullptr;
+}
+
+static bool writeAll(void* handle, const char* data, size_t size) {
+    while (size > 0) {
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+        DWORD written = 0;
+        if (!WriteFile(static_cast<HANDLE>(handle), data, chunk, &written, nullptr)) return false;
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool BufferedWriter::close(bool sync) {
+    if (!file_handle) return false;
+    flush();
+    if (sync && !FlushFileBuffers(static_cast<HANDLE>(file_handle))) failed = true;
+    if (!CloseHandle(static_cast<HANDLE>(file_handle))) failed = true;
+    file_handle = nullptr;
+    return !failed;
+}
+
+#else
+
+BufferedWriter::BufferedWriter(const std::string& filename, size_t buffer_size)
+    : buffer(std::max(buffer_size, kMaxNumberChars)) {
+    fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+}
+
+bool BufferedWriter::is_open() const {
+    return fd >= 0;
+}
+
+static bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool BufferedWriter::close(bool sync) {
+    if (fd < 0) return false;
+    flush();
+    if (sync && ::fsync(fd) != 0) failed = true;
+    if (::close(fd) != 0) failed = true;
+    fd = -1;
+    return !failed;
+}
+
+#endif
+
+BufferedWriter::~BufferedWriter() {
+    if (is_open()) close();
+}
+
+void BufferedWriter::flush() {
+    if (used == 0) return;
+    if (!is_open()) {
+        failed = true;
+    } else {
+#ifdef _WIN32
+        if (!writeAll(file_handle, buffer.data(), used)) failed = true;
+#else
+        if (!writeAll(fd, buffer.data(), used)) failed = true;
+#endif
+    }
+    used = 0;
+}
+
+// Room for at least bytes more characters at the end of the buffer
+char* BufferedWriter::reserve(size_t bytes) {
+    if (buffer.size() - used < bytes) flush();
+    return buffer.data() + used;
+}
+
+void BufferedWriter::write(std::string_view text) {
+    if (text.size() > buffer.size()) {
+        // Too big to buffer: flush what's pending and hand it to the OS directly
+        flush();
+#ifdef _WIN32
+        if (!is_open() || !writeAll(file_handle, text.data(), text.size())) failed = true;
+#else
+        if (!is_open() || !writeAll(fd, text.data(), text.size())) failed = true;
+#endif
+        return;
+    }
+    std::memcpy(reserve(text.size()), text.data(), text.size());
+    used += text.size();
+}
+
+void BufferedWriter::put(char c) {
+    *reserve(1) = c;
+    ++used;
+}
+
+void BufferedWriter::writeInt(int64_t value) {
+    char* out = reserve(kMaxNumberChars);
+    used = std::to_chars(out, out + kMaxNumberChars, value).ptr - buffer.data();
+}
+
+void BufferedWriter::writeDouble(double value, int precision) {
+    char* out = reserve(kMaxNumberChars);
+    auto result = std::to_chars(out, out + kMaxNumberChars, value, std::chars_format::general,
+                                std::clamp(precision, 1, 17));
+    used = result.ptr - buffer.data();
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Write-only output file with one large reusable buffer. Numbers are formatted in place
+// with std::to_chars, and the buffer goes to the OS in a few large writes instead of a
+// stream call (or a flush) per field.
+//
+//   BufferedWriter out("../output/flags.csv");
+//   out.write("index,flag\n");
+//   out.writeInt(i); out.put(','); out.writeDouble(x); out.put('\n');
+//   if (!out.close()) ...   // close(true) also fsyncs before closing
+class BufferedWriter {
+public:
+    explicit BufferedWriter(const std::string& filename, size_t buffer_size = 1 << 20);
+    ~BufferedWriter();  // flushes and closes; errors are only reported by close()
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    // False if the file could not be created
+    bool is_open() const;
+
+    void write(std::string_view text);
+    void put(char c);
+    void writeInt(int64_t value);
+    // Same text as an ostream with the given precision (printf "%g"), e.g. 0.0123457;
+    // precision is clamped to 1..17, which covers every distinct double
+    void writeDouble(double value, int precision = 6);
+
+    // Flushes the buffer and closes the file; with sync, the data is fsynced to disk
+    // first. False if any write since opening failed.
+    bool close(bool sync = false);
+
+private:
+    void flush();
+    char* reserve(size_t bytes);
+
+    std::vector<char> buffer;
+    size_t used = 0;
+    bool failed = false;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
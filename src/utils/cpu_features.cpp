@@ -0,0 +1,73 @@
+#include "cpu_features.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CPU_FEATURES_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+#ifdef CPU_FEATURES_X86
+
+bool cpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuidex(info, 1, 0);
+    bool osxsave = (info[2] >> 27) & 1;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 5) & 1;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool cpuHasAvx512() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    if (!cpuHasAvx2() || (_xgetbv(0) & 0xE6) != 0xE6) return false;
+    int info[4];
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 16) & 1;
+#else
+    return __builtin_cpu_supports("avx512f");
+#endif
+}
+
+#endif // CPU_FEATURES_X86
+
+std::atomic<SimdLevel> simd_level_limit{SimdLevel::AVX512};
+
+SimdLevel hardwareSimdLevel() {
+    static const SimdLevel level = [] {
+#ifdef CPU_FEATURES_X86
+        if (cpuHasAvx512()) return SimdLevel::AVX512;
+        if (cpuHasAvx2()) return SimdLevel::AVX2;
+#endif
+        return SimdLevel::Scalar;
+    }();
+    return level;
+}
+
+} // namespace
+
+SimdLevel detectSimdLevel() {
+    return std::min(hardwareSimdLevel(), simd_level_limit.load(std::memory_order_relaxed));
+}
+
+void limitSimdLevel(SimdLevel level) {
+    simd_level_limit.store(level, std::memory_order_relaxed);
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX512: return "AVX-512";
+        case SimdLevel::AVX2: return "AVX2";
+        default: return "scalar";
+    }
+}
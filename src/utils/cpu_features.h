@@ -0,0 +1,13 @@
+#pragma once
+
+// Instruction sets the vectorized kernels can use
+enum class SimdLevel { Scalar, AVX2, AVX512 };
+
+// Best level supported by this CPU and OS (checked once, at first call), capped by
+// limitSimdLevel
+SimdLevel detectSimdLevel();
+
+// Caps what detectSimdLevel reports from now on, so checks and benchmarks can exercise
+// the narrower kernels on a wider CPU. Raising the cap never exceeds the hardware.
+void limitSimdLevel(SimdLevel level);
+const char* simdLevelName(SimdLevel level);
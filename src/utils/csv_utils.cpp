@@ -1,80 +1,360 @@
 #include "csv_utils.h"
-#include <fstream>
-#include <sstream>
+#include "buffered_writer.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <string_view>
+
+namespace {
+
+// Splits the next line off the front of text, without the trailing \r\n
+bool nextLine(std::string_view& text, std::string_view& line) {
+    if (text.empty()) return false;
+
+    size_t end = text.find('\n');
+    if (end == std::string_view::npos) {
+        line = text;
+        text = {};
+    } else {
+        line = text.substr(0, end);
+        text.remove_prefix(end + 1);
+    }
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    return true;
+}
+
+// Splits the next comma-separated field off the front of line
+std::string_view nextField(std::string_view& line) {
+    size_t end = line.find(',');
+    std::string_view field = line.substr(0, end);
+    line.remove_prefix(end == std::string_view::npos ? line.size() : end + 1);
+    return field;
+}
+
+// Parses the leading number of a field (like std::stod, trailing text is ignored)
+bool parseDouble(std::string_view field, double& out) {
+    auto result = std::from_chars(field.data(), field.data() + field.size(), out);
+    return result.ec == std::errc();
+}
+
+size_t estimateRows(std::string_view text) {
+    return static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+}
+
+using ColumnMask = std::array<bool, kFeatureColumnCount>;
+
+// One slot per FeatureColumn plus a trailing discard slot for fields nobody asked for
+constexpr size_t kDiscardSlot = kFeatureColumnCount;
+using FieldViews = std::array<std::string_view, kFeatureColumnCount + 1>;
+
+// Column layout of a particular file, compiled once from its header
+struct FieldMap {
+    std::vector<uint8_t> slot_of;  // file position -> FeatureColumn slot or kDiscardSlot
+    size_t field_count = 0;        // positions to split per row; later fields are never scanned
+    ColumnMask present{};          // columns the header provides
+};
+
+// Consumes the header line of text and resolves where each wanted column lives.
+// Unknown headers (such as the unnamed pandas index) and unwanted columns go to the
+// discard slot. Fails if Date or Ticker is wanted but missing.
+bool compileFieldMap(std::string_view& text, const ColumnMask& wanted,
+                     const std::string& filename, FieldMap& map) {
+    std::string_view header;
+    if (!nextLine(text, header)) {
+        std::cerr << "Missing header in " << filename << "\n";
+        return false;
+    }
+
+    for (size_t position = 0; !header.empty(); ++position) {
+        FeatureColumn column;
+        uint8_t slot = kDiscardSlot;
+        if (featureColumnFromName(nextField(header), column)) {
+            size_t c = static_cast<size_t>(column);
+            if (!map.present[c]) {
+                map.present[c] = true;
+                if (wanted[c]) {
+                    slot = static_cast<uint8_t>(c);
+                    map.field_count = position + 1;
+                }
+            }
+        }
+        map.slot_of.push_back(slot);
+    }
+
+    for (FeatureColumn required : {FeatureColumn::Date, FeatureColumn::Ticker}) {
+        size_t c = static_cast<size_t>(required);
+        if (wanted[c] && !map.present[c]) {
+            std::cerr << "Missing " << (required == FeatureColumn::Date ? "Date" : "Ticker")
+                      << " column in " << filename << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Walks every data row after the header and hands the mapped fields to sink(fields),
+// indexed by FeatureColumn. Every field is stored through the map without branching
+// on its position. sink returns false to reject a malformed row.
+template <typename Sink>
+void scanFeatureRows(std::string_view text, const FieldMap& map,
+                     const std::string& filename, Sink&& sink) {
+    std::string_view line;
+    FieldViews fields{};
+    size_t skipped = 0;
+    while (nextLine(text, line)) {
+        if (line.empty()) continue;
+
+        for (size_t position = 0; position < map.field_count; ++position) {
+            fields[map.slot_of[position]] = nextField(line);
+        }
+
+        if (!sink(fields)) {
+            ++skipped;
+        }
+    }
+
+    if (skipped > 0) {
+        std::cerr << "Skipped " << skipped << " malformed rows in " << filename << "\n";
+    }
+}
+
+std::string_view field(const FieldViews& fields, FeatureColumn c) {
+    return fields[static_cast<size_t>(c)];
+}
+
+} // namespace
 
 std::vector<StockRow> read_features_csv(const std::string& filename) {
     std::vector<StockRow> data;
-    std::ifstream file(filename);
-    std::string line;
+    MappedFile file(filename);
 
     if (!file.is_open()) {
         std::cerr << "Failed to open file: " << filename << "\n";
         return data;
     }
 
-    std::getline(file, line);
+    std::string_view text = file.data();
+    data.reserve(estimateRows(text));
+
+    ColumnMask all;
+    all.fill(true);
+    FieldMap map;
+    if (!compileFieldMap(text, all, filename, map)) {
+        return data;
+    }
+
+    // Columns the file doesn't have (e.g. Adj Close in newer exports) are left as NaN
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    auto parse = [&](const FieldViews& fields, FeatureColumn c, double& out) {
+        if (!map.present[static_cast<size_t>(c)]) {
+            out = missing;
+            return true;
+        }
+        return parseDouble(field(fields, c), out);
+    };
 
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string cell;
+    scanFeatureRows(text, map, filename, [&](const FieldViews& fields) {
         StockRow row;
+        bool ok = true;
 
-        std::getline(ss, row.date, ',');
-        std::getline(ss, cell, ','); row.open = std::stod(cell);
-        std::getline(ss, cell, ','); row.high = std::stod(cell);
-        std::getline(ss, cell, ','); row.low = std::stod(cell);
-        std::getline(ss, cell, ','); row.close = std::stod(cell);
-        std::getline(ss, cell, ','); row.adj_close = std::stod(cell);
-        std::getline(ss, cell, ','); row.volume = std::stod(cell);
-        std::getline(ss, row.ticker, ',');
-        std::getline(ss, cell, ','); row.daily_return = std::stod(cell);
-        std::getline(ss, cell, ','); row.volatility = std::stod(cell);
-        std::getline(ss, cell, ','); row.volume_zscore = std::stod(cell);
+        row.date = field(fields, FeatureColumn::Date);
+        ok &= parse(fields, FeatureColumn::Open, row.open);
+        ok &= parse(fields, FeatureColumn::High, row.high);
+        ok &= parse(fields, FeatureColumn::Low, row.low);
+        ok &= parse(fields, FeatureColumn::Close, row.close);
+        ok &= parse(fields, FeatureColumn::AdjClose, row.adj_close);
+        ok &= parse(fields, FeatureColumn::Volume, row.volume);
+        row.ticker = field(fields, FeatureColumn::Ticker);
+        ok &= parse(fields, FeatureColumn::DailyReturn, row.daily_return);
+        ok &= parse(fields, FeatureColumn::Volatility, row.volatility);
+        ok &= parse(fields, FeatureColumn::VolumeZScore, row.volume_zscore);
 
-        data.push_back(row);
-    }
+        if (ok) data.push_back(std::move(row));
+        return ok;
+    });
 
     return data;
 }
 
+bool read_feature_columns(const std::string& filename,
+                          const std::vector<FeatureColumn>& columns,
+                          std::vector<std::vector<double>>& out,
+                          std::vector<std::string>* tickers) {
+    ColumnMask wanted{};
+    for (FeatureColumn c : columns) {
+        if (c == FeatureColumn::Date || c == FeatureColumn::Ticker) {
+            std::cerr << "read_feature_columns: only numeric columns can be projected\n";
+            return false;
+        }
+        wanted[static_cast<size_t>(c)] = true;
+    }
+    if (tickers) {
+        wanted[static_cast<size_t>(FeatureColumn::Ticker)] = true;
+    }
+
+    MappedFile file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << filename << "\n";
+        return false;
+    }
+
+    std::string_view text = file.data();
+    FieldMap map;
+    if (!compileFieldMap(text, wanted, filename, map)) {
+        return false;
+    }
+    for (FeatureColumn c : columns) {
+        if (!map.present[static_cast<size_t>(c)]) {
+            std::cerr << "Requested column is missing from " << filename << "\n";
+            return false;
+        }
+    }
+
+    size_t expected_rows = estimateRows(text);
+    out.assign(columns.size(), {});
+    for (auto& column : out) column.reserve(expected_rows);
+    if (tickers) {
+        tickers->clear();
+        tickers->reserve(expected_rows);
+    }
+
+    std::vector<double> values(columns.size());
+    scanFeatureRows(text, map, filename, [&](const FieldViews& fields) {
+        for (size_t k = 0; k < columns.size(); ++k) {
+            if (!parseDouble(field(fields, columns[k]), values[k])) return false;
+        }
+        for (size_t k = 0; k < columns.size(); ++k) {
+            out[k].push_back(values[k]);
+        }
+        if (tickers) {
+            tickers->emplace_back(field(fields, FeatureColumn::Ticker));
+        }
+        return true;
+    });
+
+    return true;
+}
+
+bool read_feature_table(const std::string& filename, FeatureTable& table) {
+    return read_feature_table(filename, table, {
+        FeatureColumn::Open, FeatureColumn::High, FeatureColumn::Low, FeatureColumn::Close,
+        FeatureColumn::AdjClose, FeatureColumn::Volume, FeatureColumn::DailyReturn,
+        FeatureColumn::Volatility, FeatureColumn::VolumeZScore});
+}
+
+bool read_feature_table(const std::string& filename, FeatureTable& table,
+                        const std::vector<FeatureColumn>& columns) {
+    table.clear();
+
+    ColumnMask wanted{};
+    wanted[static_cast<size_t>(FeatureColumn::Date)] = true;
+    wanted[static_cast<size_t>(FeatureColumn::Ticker)] = true;
+
+    for (FeatureColumn c : columns) {
+        wanted[static_cast<size_t>(c)] = true;
+    }
+
+    MappedFile file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << filename << "\n";
+        return false;
+    }
+
+    std::string_view text = file.data();
+    FieldMap map;
+    if (!compileFieldMap(text, wanted, filename, map)) {
+        return false;
+    }
+
+    // Requested numeric columns the file provides, paired with their destination vectors.
+    // Columns the file lacks stay empty in the table.
+    std::vector<FeatureColumn> loaded;
+    std::vector<std::vector<double>*> targets;
+    for (size_t c = 0; c < kFeatureColumnCount; ++c) {
+        std::vector<double>* target = table.mutableColumn(static_cast<FeatureColumn>(c));
+        if (wanted[c] && map.present[c] && target) {
+            loaded.push_back(static_cast<FeatureColumn>(c));
+            targets.push_back(target);
+        }
+    }
+
+    size_t expected_rows = estimateRows(text);
+    table.dates.reserve(expected_rows);
+    table.ticker_ids.reserve(expected_rows);
+    for (auto* target : targets) target->reserve(expected_rows);
+
+    std::vector<double> values(loaded.size());
+    scanFeatureRows(text, map, filename, [&](const FieldViews& fields) {
+        for (size_t k = 0; k < loaded.size(); ++k) {
+            if (!parseDouble(field(fields, loaded[k]), values[k])) return false;
+        }
+        for (size_t k = 0; k < loaded.size(); ++k) {
+            targets[k]->push_back(values[k]);
+        }
+        table.dates.push_back(parseDayNumber(field(fields, FeatureColumn::Date)));
+        table.ticker_ids.push_back(table.internTicker(field(fields, FeatureColumn::Ticker)));
+        return true;
+    });
+
+    return true;
+}
+
 void write_anomaly_output(const std::string& filename, const std::vector<StockRow>& data, const std::vector<int>& flags) {
-    std::ofstream file(filename);
+    BufferedWriter file(filename);
     if (!file.is_open()) {
         std::cerr << "Failed to write to: " << filename << "\n";
         return;
     }
 
-    file << "Date,Ticker,Open,High,Low,Close,Adj Close,Volume,Daily Return,Volatility,Volume Z-Score,Anomaly\n";
+    file.write("Date,Ticker,Open,High,Low,Close,Adj Close,Volume,Daily Return,Volatility,Volume Z-Score,Anomaly\n");
 
     for (size_t i = 0; i < data.size(); ++i) {
         const auto& row = data[i];
-        file << row.date << "," << row.ticker << ","
-             << row.open << "," << row.high << "," << row.low << ","
-             << row.close << "," << row.adj_close << "," << row.volume << ","
-             << row.daily_return << "," << row.volatility << "," << row.volume_zscore << ","
-             << flags[i] << "\n";
+        file.write(row.date);
+        file.put(',');
+        file.write(row.ticker);
+        for (double value : {row.open, row.high, row.low, row.close, row.adj_close, row.volume,
+                             row.daily_return, row.volatility, row.volume_zscore}) {
+            file.put(',');
+            file.writeDouble(value);
+        }
+        file.put(',');
+        file.writeInt(flags[i]);
+        file.put('\n');
     }
 
-    file.close();
+    if (!file.close()) {
+        std::cerr << "Failed to write to: " << filename << "\n";
+    }
 }
 
 // ADD THIS FUNCTION AT THE END - Implementation of loadCSV
-bool loadCSV(const std::string& filename, std::vector<double>& data) {
-    // Use your existing read_features_csv function
-    auto stock_data = read_features_csv(filename);
-    
-    if (stock_data.empty()) {
+static bool loadDailyReturns(const std::string& filename, std::vector<double>& data,
+                             std::vector<std::string>* tickers) {
+    // Only daily_return (and optionally the ticker) is parsed; every other field is skipped
+    std::vector<std::vector<double>> columns;
+    if (!read_feature_columns(filename, {FeatureColumn::DailyReturn}, columns, tickers) ||
+        columns[0].empty()) {
         std::cerr << "Error: No data loaded from " << filename << std::endl;
         return false;
     }
     
-    // Extract daily_return values as the feature to analyze for anomalies
-    data.reserve(stock_data.size());
-    for (const auto& row : stock_data) {
-        data.push_back(row.daily_return);
-    }
+    data = std::move(columns[0]);
     
     std::cout << "Successfully loaded " << data.size() << " data points from " << filename << std::endl;
     return true;
 }
+
+bool loadCSV(const std::string& filename, std::vector<double>& data) {
+    return loadDailyReturns(filename, data, nullptr);
+}
+
+bool loadCSV(const std::string& filename, std::vector<double>& data, std::vector<std::string>& tickers) {
+    return loadDailyReturns(filename, data, &tickers);
+}
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include "feature_table.h"
 
 // represents a row from features.csv
 struct StockRow {
@@ -19,13 +20,32 @@ struct StockRow {
     double volume_zscore;
 };
 
-// reads the features.csv file
+// reads the features.csv file (memory-mapped and parsed in place).
+// Columns are located by header name, so the column order of the export doesn't matter;
+// numeric columns missing from the file are set to NaN.
 std::vector<StockRow> read_features_csv(const std::string& filename);
 
 // writes a new CSV that includes an anomaly flag column
 void write_anomaly_output(const std::string& filename, const std::vector<StockRow>& data, const std::vector<int>& flags);
 
+// loads only the requested numeric columns of features.csv; columns[k] is written to out[k].
+// Unrequested fields are skipped in place without being parsed or copied. Tickers are
+// only materialized when a tickers vector is passed in.
+bool read_feature_columns(const std::string& filename,
+                          const std::vector<FeatureColumn>& columns,
+                          std::vector<std::vector<double>>& out,
+                          std::vector<std::string>* tickers = nullptr);
+
+// loads features.csv into a columnar FeatureTable. Dates and tickers are always loaded;
+// the overload with a column list only fills those numeric columns and leaves the rest empty.
+bool read_feature_table(const std::string& filename, FeatureTable& table);
+bool read_feature_table(const std::string& filename, FeatureTable& table,
+                        const std::vector<FeatureColumn>& columns);
+
 // ADD THIS LINE - loads CSV data into a simple vector of doubles for anomaly detection
 bool loadCSV(const std::string& filename, std::vector<double>& data);
 
+// same as above, but also returns the ticker of each row so series can be split per stock
+bool loadCSV(const std::string& filename, std::vector<double>& data, std::vector<std::string>& tickers);
+
 #endif // CSV_UTILS_H
\ No newline at end of file
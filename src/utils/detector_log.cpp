@@ -0,0 +1,40 @@
+#include "detector_log.h"
+
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+namespace detector_log_detail {
+
+std::atomic<int> level{static_cast<int>(DetectorLogLevel::Off)};
+
+namespace {
+DetectorLogSink& sink() {
+    static DetectorLogSink instance;
+    return instance;
+}
+}
+
+void emit(DetectorLogLevel level, std::string_view message) {
+    const DetectorLogSink& current = sink();
+    if (current) current(level, message);
+}
+
+} // namespace detector_log_detail
+
+void setDetectorLogSink(DetectorLogSink sink) {
+    detector_log_detail::sink() = std::move(sink);
+}
+
+void setDetectorLogLevel(DetectorLogLevel level) {
+    detector_log_detail::level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+DetectorLogSink streamLogSink(std::ostream& out) {
+    auto lock = std::make_shared<std::mutex>();
+    return [&out, lock](DetectorLogLevel, std::string_view message) {
+        std::lock_guard<std::mutex> guard(*lock);
+        out << message << '\n';
+    };
+}
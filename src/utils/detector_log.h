@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <iosfwd>
+#include <sstream>
+#include <string_view>
+
+// Diagnostic output from the detectors in src/algs, routed through one pluggable sink.
+// Logging is off by default: a disabled DETECTOR_LOG is a single relaxed atomic load,
+// and the message is only formatted when a sink would actually see it.
+//
+//   setDetectorLogSink(streamLogSink(std::cerr));
+//   setDetectorLogLevel(DetectorLogLevel::Debug);
+//   DETECTOR_LOG(Debug, "Median: " << median << ", Robust STD: " << robust_std);
+//
+// The sink can be called from several threads at once (e.g. the per-ticker parallel
+// detectors), so it must be thread-safe; streamLogSink locks around each line.
+
+enum class DetectorLogLevel : int {
+    Off = 0,
+    Info = 1,   // one line per detector call
+    Debug = 2,  // per-candidate detail, e.g. each threshold a search tries
+};
+
+using DetectorLogSink = std::function<void(DetectorLogLevel, std::string_view)>;
+
+// Replaces the sink; an empty sink discards everything. Set it before running detectors.
+void setDetectorLogSink(DetectorLogSink sink);
+
+// Highest level that reaches the sink; Off (the default) disables logging entirely
+void setDetectorLogLevel(DetectorLogLevel level);
+
+// Sink that writes each message as one line to out, serialized with a mutex
+DetectorLogSink streamLogSink(std::ostream& out);
+
+namespace detector_log_detail {
+extern std::atomic<int> level;
+void emit(DetectorLogLevel level, std::string_view message);
+}
+
+// Off is a threshold, not a message level: DETECTOR_LOG(Off, ...) never reaches the sink
+inline bool detectorLogEnabled(DetectorLogLevel level) {
+    return level != DetectorLogLevel::Off &&
+           static_cast<int>(level) <= detector_log_detail::level.load(std::memory_order_relaxed);
+}
+
+// message is a stream expression; it is not evaluated unless the level is enabled
+#define DETECTOR_LOG(lvl, message)                                                   \
+    do {                                                                             \
+        if (detectorLogEnabled(DetectorLogLevel::lvl)) {                             \
+            std::ostringstream detector_log_stream;                                  \
+            detector_log_stream << message;                                          \
+            detector_log_detail::emit(DetectorLogLevel::lvl, detector_log_stream.str()); \
+        }                                                                            \
+    } while (0)
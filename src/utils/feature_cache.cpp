@@ -0,0 +1,281 @@
+#include "feature_cache.h"
+#include "csv_utils.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <system_error>
+
+namespace {
+
+constexpr char kMagic[8] = {'P', '3', 'F', 'C', 'A', 'C', 'H', 'E'};
+constexpr uint64_t kBlockAlignment = 64;
+
+// Column names and element types in FeatureColumn order; change this string whenever the
+// layout changes so older caches stop matching
+constexpr std::string_view kSchema =
+    "date:i32,open:f64,high:f64,low:f64,close:f64,adj_close:f64,volume:f64,"
+    "ticker:u32,daily_return:f64,volatility:f64,volume_zscore:f64,ticker_names:str";
+static_assert(kFeatureColumnCount == 11, "update kSchema when FeatureColumn changes");
+
+uint64_t alignUp(uint64_t offset) {
+    return (offset + kBlockAlignment - 1) & ~(kBlockAlignment - 1);
+}
+
+// FNV-1a of the schema string and the struct sizes it is written with
+uint64_t schemaHash() {
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&](unsigned char byte) {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    };
+    for (char c : kSchema) mix(static_cast<unsigned char>(c));
+    mix(static_cast<unsigned char>(sizeof(FeatureCacheHeader)));
+    mix(static_cast<unsigned char>(sizeof(FeatureCacheBlock)));
+    return hash;
+}
+
+bool sourceStamp(const std::string& csv_filename, uint64_t& size, int64_t& mtime) {
+    std::error_code error;
+    auto file_size = std::filesystem::file_size(csv_filename, error);
+    if (error) return false;
+    auto write_time = std::filesystem::last_write_time(csv_filename, error);
+    if (error) return false;
+
+    size = file_size;
+    mtime = static_cast<int64_t>(write_time.time_since_epoch().count());
+    return true;
+}
+
+struct PendingBlock {
+    uint32_t kind;
+    uint32_t element_size;
+    const void* data;
+    uint64_t bytes;
+};
+
+// The ticker dictionary as uint32 offsets[count + 1] followed by the name bytes
+std::vector<char> packTickerNames(const std::vector<std::string>& names) {
+    std::vector<uint32_t> offsets;
+    offsets.reserve(names.size() + 1);
+    uint32_t position = 0;
+    for (const std::string& name : names) {
+        offsets.push_back(position);
+        position += static_cast<uint32_t>(name.size());
+    }
+    offsets.push_back(position);
+
+    std::vector<char> packed(offsets.size() * sizeof(uint32_t) + position);
+    std::memcpy(packed.data(), offsets.data(), offsets.size() * sizeof(uint32_t));
+    char* out = packed.data() + offsets.size() * sizeof(uint32_t);
+    for (const std::string& name : names) {
+        std::memcpy(out, name.data(), name.size());
+        out += name.size();
+    }
+    return packed;
+}
+
+bool unpackTickerNames(std::string_view block, uint64_t count, FeatureTable& table) {
+    uint64_t offsets_bytes = (count + 1) * sizeof(uint32_t);
+    if (block.size() < offsets_bytes) return false;
+
+    std::vector<uint32_t> offsets(count + 1);
+    std::memcpy(offsets.data(), block.data(), offsets_bytes);
+    std::string_view bytes = block.substr(offsets_bytes);
+    for (uint64_t i = 0; i < count; ++i) {
+        if (offsets[i] > offsets[i + 1] || offsets[i + 1] > bytes.size()) return false;
+        table.internTicker(bytes.substr(offsets[i], offsets[i + 1] - offsets[i]));
+    }
+    return table.ticker_names.size() == count;
+}
+
+} // namespace
+
+std::string featureCachePath(const std::string& csv_filename) {
+    return csv_filename + ".p3cache";
+}
+
+bool writeFeatureCache(const std::string& cache_filename,
+                       const std::string& csv_filename,
+                       const FeatureTable& table) {
+    if constexpr (std::endian::native != std::endian::little) return false;
+
+    FeatureCacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFeatureCacheVersion;
+    header.schema_hash = schemaHash();
+    header.row_count = table.size();
+    header.ticker_count = table.ticker_names.size();
+    if (!csv_filename.empty() && !sourceStamp(csv_filename, header.source_size, header.source_mtime)) {
+        return false;
+    }
+
+    std::vector<char> names = packTickerNames(table.ticker_names);
+    std::vector<PendingBlock> pending;
+    pending.push_back({static_cast<uint32_t>(FeatureColumn::Date), sizeof(int32_t),
+                       table.dates.data(), table.dates.size() * sizeof(int32_t)});
+    pending.push_back({static_cast<uint32_t>(FeatureColumn::Ticker), sizeof(uint32_t),
+                       table.ticker_ids.data(), table.ticker_ids.size() * sizeof(uint32_t)});
+    for (size_t c = 0; c < kFeatureColumnCount; ++c) {
+        FeatureColumn column_id = static_cast<FeatureColumn>(c);
+        if (column_id == FeatureColumn::Date || column_id == FeatureColumn::Ticker) continue;
+        std::span<const double> column = table.column(column_id);
+        pending.push_back({static_cast<uint32_t>(c), sizeof(double), column.data(), column.size_bytes()});
+    }
+    pending.push_back({kTickerNamesBlock, 1, names.data(), names.size()});
+    header.block_count = static_cast<uint32_t>(pending.size());
+
+    std::vector<FeatureCacheBlock> directory;
+    uint64_t offset = alignUp(sizeof(header) + pending.size() * sizeof(FeatureCacheBlock));
+    for (const PendingBlock& block : pending) {
+        directory.push_back({block.kind, block.element_size, offset, block.bytes});
+        offset = alignUp(offset + block.bytes);
+    }
+
+    std::string temp_filename = cache_filename + ".tmp";
+    {
+        std::ofstream out(temp_filename, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        static const char padding[kBlockAlignment] = {};
+        auto pad_to = [&](uint64_t target) {
+            uint64_t position = static_cast<uint64_t>(out.tellp());
+            out.write(padding, static_cast<std::streamsize>(target - position));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(directory.data()),
+                  static_cast<std::streamsize>(directory.size() * sizeof(FeatureCacheBlock)));
+        for (size_t b = 0; b < pending.size(); ++b) {
+            pad_to(directory[b].offset);
+            out.write(static_cast<const char*>(pending[b].data), static_cast<std::streamsize>(pending[b].bytes));
+        }
+        pad_to(offset);
+        if (!out) {
+            out.close();
+            std::filesystem::remove(temp_filename);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_filename, cache_filename, error);
+    if (error) {
+        std::filesystem::remove(temp_filename, error);
+        return false;
+    }
+    return true;
+}
+
+bool readFeatureCache(const std::string& cache_filename,
+                      const std::string& csv_filename,
+                      FeatureTable& table,
+                      const std::vector<FeatureColumn>& columns) {
+    table.clear();
+    if constexpr (std::endian::native != std::endian::little) return false;
+
+    MappedFile file(cache_filename);
+    if (!file.is_open() || file.size() < sizeof(FeatureCacheHeader)) return false;
+    std::string_view data = file.data();
+
+    FeatureCacheHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kFeatureCacheVersion ||
+        header.schema_hash != schemaHash()) {
+        return false;
+    }
+
+    uint64_t source_size = 0;
+    int64_t source_mtime = 0;
+    if (!csv_filename.empty() && !sourceStamp(csv_filename, source_size, source_mtime)) {
+        return false;
+    }
+    if (source_size != header.source_size || source_mtime != header.source_mtime) {
+        return false;
+    }
+
+    uint64_t directory_end = sizeof(header) + uint64_t{header.block_count} * sizeof(FeatureCacheBlock);
+    if (directory_end > data.size()) return false;
+    std::vector<FeatureCacheBlock> directory(header.block_count);
+    std::memcpy(directory.data(), data.data() + sizeof(header), directory.size() * sizeof(FeatureCacheBlock));
+
+    // Block contents by kind; every block must lie inside the file and hold whole rows
+    auto find_block = [&](uint32_t kind, std::string_view& block) {
+        for (const FeatureCacheBlock& entry : directory) {
+            if (entry.kind != kind) continue;
+            if (entry.offset > data.size() || entry.bytes > data.size() - entry.offset) return false;
+            if (kind != kTickerNamesBlock && entry.bytes != 0 &&
+                entry.bytes != header.row_count * entry.element_size) {
+                return false;
+            }
+            block = data.substr(entry.offset, entry.bytes);
+            return true;
+        }
+        return false;
+    };
+
+    std::string_view dates, ticker_ids, names;
+    if (!find_block(static_cast<uint32_t>(FeatureColumn::Date), dates) ||
+        !find_block(static_cast<uint32_t>(FeatureColumn::Ticker), ticker_ids) ||
+        !find_block(kTickerNamesBlock, names) ||
+        ticker_ids.size() != header.row_count * sizeof(uint32_t) ||
+        dates.size() != header.row_count * sizeof(int32_t)) {
+        return false;
+    }
+
+    if (!unpackTickerNames(names, header.ticker_count, table)) {
+        table.clear();
+        return false;
+    }
+
+    table.dates.resize(header.row_count);
+    std::memcpy(table.dates.data(), dates.data(), dates.size());
+    table.ticker_ids.resize(header.row_count);
+    std::memcpy(table.ticker_ids.data(), ticker_ids.data(), ticker_ids.size());
+    if (std::any_of(table.ticker_ids.begin(), table.ticker_ids.end(),
+                    [&](uint32_t id) { return id >= header.ticker_count; })) {
+        table.clear();
+        return false;
+    }
+
+    // Only the requested blocks are touched, so unrequested columns are never paged in
+    for (FeatureColumn c : columns) {
+        std::vector<double>* target = table.mutableColumn(c);
+        std::string_view block;
+        if (!target || !find_block(static_cast<uint32_t>(c), block)) continue;
+        target->resize(block.size() / sizeof(double));
+        std::memcpy(target->data(), block.data(), block.size());
+    }
+    return true;
+}
+
+bool loadFeatureTableCached(const std::string& csv_filename,
+                            FeatureTable& table,
+                            const std::vector<FeatureColumn>& columns) {
+    std::string cache_filename = featureCachePath(csv_filename);
+    if (readFeatureCache(cache_filename, csv_filename, table, columns)) {
+        return true;
+    }
+
+    // Cache missing or stale: parse every column once so the cache can serve any request
+    if (!read_feature_table(csv_filename, table)) {
+        return false;
+    }
+    if (!writeFeatureCache(cache_filename, csv_filename, table)) {
+        std::cerr << "Could not write feature cache: " << cache_filename << "\n";
+    }
+
+    for (size_t c = 0; c < kFeatureColumnCount; ++c) {
+        FeatureColumn column = static_cast<FeatureColumn>(c);
+        std::vector<double>* target = table.mutableColumn(column);
+        if (target && std::find(columns.begin(), columns.end(), column) == columns.end()) {
+            std::vector<double>().swap(*target);
+        }
+    }
+    return true;
+}
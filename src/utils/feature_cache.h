@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "feature_table.h"
+
+// Binary columnar cache of a parsed features CSV, kept next to it as "<csv>.p3cache".
+//
+// Layout (little-endian):
+//   FeatureCacheHeader (64 bytes)
+//   FeatureCacheBlock directory, one entry per block
+//   blocks, each starting on a 64-byte boundary:
+//     dates (int32), ticker ids (uint32), one double block per numeric column,
+//     ticker names (uint32 offsets[count + 1] followed by the concatenated bytes)
+//
+// A cache is only used when its magic, version and schema hash match this build and the
+// recorded source size and mtime match the CSV on disk, so editing or replacing the CSV
+// invalidates it automatically.
+
+constexpr uint32_t kFeatureCacheVersion = 1;
+
+// Block kind of the ticker dictionary; the other blocks use their FeatureColumn value
+constexpr uint32_t kTickerNamesBlock = 0xFFFFFFFFu;
+
+struct FeatureCacheHeader {
+    char magic[8];              // "P3FCACHE"
+    uint32_t version;
+    uint32_t block_count;
+    uint64_t schema_hash;       // FeatureColumn list and element types this build writes
+    uint64_t source_size;       // CSV size in bytes
+    int64_t source_mtime;       // CSV last-write time, filesystem clock ticks
+    uint64_t row_count;
+    uint64_t ticker_count;
+    uint64_t reserved;
+};
+
+struct FeatureCacheBlock {
+    uint32_t kind;              // FeatureColumn value, or kTickerNamesBlock
+    uint32_t element_size;
+    uint64_t offset;            // from the start of the file
+    uint64_t bytes;             // 0 for a column the CSV didn't have
+};
+
+static_assert(sizeof(FeatureCacheHeader) == 64);
+static_assert(sizeof(FeatureCacheBlock) == 24);
+
+// Default cache location for a CSV
+std::string featureCachePath(const std::string& csv_filename);
+
+// Writes every column of table to cache_filename, stamped with the current size and mtime
+// of csv_filename. The file is written under a temporary name and renamed into place, so
+// readers never see a partial cache. False if it could not be written.
+// An empty csv_filename writes a standalone cache (e.g. generated data) with a zero stamp;
+// read it back with an empty csv_filename too.
+bool writeFeatureCache(const std::string& cache_filename,
+                       const std::string& csv_filename,
+                       const FeatureTable& table);
+
+// Loads dates, tickers and the requested numeric columns from a memory-mapped cache.
+// False (with table cleared) if the cache is missing, from another version or schema,
+// truncated, or older than csv_filename.
+bool readFeatureCache(const std::string& cache_filename,
+                      const std::string& csv_filename,
+                      FeatureTable& table,
+                      const std::vector<FeatureColumn>& columns);
+
+// read_feature_table through the cache: uses the cache when it is current, otherwise
+// parses the whole CSV, rewrites the cache and keeps only the requested numeric columns.
+// A cache that can't be written is not an error.
+bool loadFeatureTableCached(const std::string& csv_filename,
+                            FeatureTable& table,
+                            const std::vector<FeatureColumn>& columns);
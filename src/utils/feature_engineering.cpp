@@ -0,0 +1,101 @@
+#include "feature_engineering.h"
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "feature_cache.h"
+#include "phase_timer.h"
+#include "rolling_stats.h"
+
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+struct TickerState {
+    double previous_close = kNaN;
+    RollingStats returns;
+    RollingStats volumes;
+
+    TickerState(const FeatureWindows& windows)
+        : returns(windows.volatility), volumes(windows.volume_zscore) {}
+};
+
+} // namespace
+
+void computeFeatures(FeatureTable& table, const FeatureWindows& windows) {
+    PROFILE_PHASE_ROWS("compute features", table.size());
+    size_t rows = table.size();
+    bool have_close = table.close.size() == rows;
+    bool have_volume = table.volume.size() == rows;
+
+    table.daily_return.assign(rows, kNaN);
+    table.volatility.assign(rows, kNaN);
+    table.volume_zscore.assign(rows, kNaN);
+
+    std::vector<TickerState> states(table.ticker_names.size(), TickerState(windows));
+
+    for (size_t row = 0; row < rows; ++row) {
+        TickerState& state = states[table.ticker_ids[row]];
+
+        if (have_close) {
+            double close = table.close[row];
+            double daily_return = (close - state.previous_close) / state.previous_close;
+            if (!std::isnan(close)) state.previous_close = close;
+
+            if (!std::isnan(daily_return)) {
+                table.daily_return[row] = daily_return;
+                state.returns.add(daily_return);
+                if (state.returns.ready()) {
+                    table.volatility[row] = state.returns.sampleStddev();
+                }
+            }
+        }
+
+        if (have_volume) {
+            double volume = table.volume[row];
+            if (!std::isnan(volume)) {
+                state.volumes.add(volume);
+                if (state.volumes.ready()) {
+                    // A flat window divides by zero, giving inf/NaN like pandas
+                    table.volume_zscore[row] = (volume - state.volumes.mean()) / state.volumes.sampleStddev();
+                }
+            }
+        }
+    }
+}
+
+void dropIncompleteRows(FeatureTable& table) {
+    PROFILE_PHASE_ROWS("drop incomplete rows", table.size());
+    std::vector<uint8_t> keep(table.size(), 1);
+    for (size_t row = 0; row < table.dates.size(); ++row) {
+        if (table.dates[row] == kInvalidDay) keep[row] = 0;
+    }
+    for (size_t c = 0; c < kFeatureColumnCount; ++c) {
+        std::span<const double> values = table.column(static_cast<FeatureColumn>(c));
+        if (values.size() != keep.size()) continue;
+        for (size_t row = 0; row < values.size(); ++row) {
+            if (std::isnan(values[row])) keep[row] = 0;
+        }
+    }
+    table.retainRows(keep);
+}
+
+bool buildFeatureTable(const std::string& stock_filename,
+                       FeatureTable& table,
+                       const FeatureWindows& windows) {
+    // Row counts are only known once the file is read; both phases report rows read
+    PROFILE_SCOPE(build_phase, "build features");
+    {
+        PROFILE_SCOPE(read_phase, "read prices");
+        if (!loadFeatureTableCached(stock_filename, table, {
+                FeatureColumn::Open, FeatureColumn::High, FeatureColumn::Low,
+                FeatureColumn::Close, FeatureColumn::AdjClose, FeatureColumn::Volume})) {
+            return false;
+        }
+        PROFILE_SET_ROWS(read_phase, table.size());
+    }
+    PROFILE_SET_ROWS(build_phase, table.size());
+
+    computeFeatures(table, windows);
+    dropIncompleteRows(table);
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include "feature_table.h"
+
+// Window lengths of the derived features (the defaults are preprocess_features.py's)
+struct FeatureWindows {
+    int volatility = 10;     // rolling std of daily returns
+    int volume_zscore = 20;  // rolling mean/std of volume
+};
+
+// Fills DailyReturn, Volatility and VolumeZScore from the table's Close and Volume
+// columns, per ticker, in one pass over the rows in file order. Each ticker keeps its
+// previous close and two RollingStats, so the cost is O(rows) for any window length.
+// Matches pandas: pct_change for the return, sample (n - 1) rolling std, and NaN until
+// a ticker has a full window. NaN returns and volumes are skipped, not added to windows.
+void computeFeatures(FeatureTable& table, const FeatureWindows& windows = {});
+
+// Drops rows with an unparsed date or a NaN in any loaded numeric column, like DataFrame.dropna()
+void dropIncompleteRows(FeatureTable& table);
+
+// Native replacement for preprocess_features.py: loads raw prices (stock_data.csv, or
+// its binary cache), computes the features and drops incomplete rows, leaving the table
+// as features.csv would have it without writing the intermediate file.
+bool buildFeatureTable(const std::string& stock_filename,
+                       FeatureTable& table,
+                       const FeatureWindows& windows = {});
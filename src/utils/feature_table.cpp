@@ -0,0 +1,126 @@
+#include "feature_table.h"
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+
+bool featureColumnFromName(std::string_view name, FeatureColumn& column) {
+    std::string key;
+    for (char ch : name) {
+        if (std::isalnum(static_cast<unsigned char>(ch))) {
+            key.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(ch))));
+        }
+    }
+
+    static const std::pair<const char*, FeatureColumn> kNames[] = {
+        {"date", FeatureColumn::Date},
+        {"open", FeatureColumn::Open},
+        {"high", FeatureColumn::High},
+        {"low", FeatureColumn::Low},
+        {"close", FeatureColumn::Close},
+        {"adjclose", FeatureColumn::AdjClose},
+        {"volume", FeatureColumn::Volume},
+        {"ticker", FeatureColumn::Ticker},
+        {"symbol", FeatureColumn::Ticker},
+        {"dailyreturn", FeatureColumn::DailyReturn},
+        {"volatility", FeatureColumn::Volatility},
+        {"volumezscore", FeatureColumn::VolumeZScore},
+    };
+    for (const auto& [known, value] : kNames) {
+        if (key == known) {
+            column = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+int32_t parseDayNumber(std::string_view date) {
+    if (date.size() < 10 || date[4] != '-' || date[7] != '-') return kInvalidDay;
+
+    int y = 0;
+    unsigned m = 0, d = 0;
+    const char* s = date.data();
+    if (std::from_chars(s, s + 4, y).ptr != s + 4 ||
+        std::from_chars(s + 5, s + 7, m).ptr != s + 7 ||
+        std::from_chars(s + 8, s + 10, d).ptr != s + 10) {
+        return kInvalidDay;
+    }
+
+    std::chrono::year_month_day ymd{std::chrono::year{y}, std::chrono::month{m}, std::chrono::day{d}};
+    if (!ymd.ok()) return kInvalidDay;
+    return static_cast<int32_t>(std::chrono::sys_days{ymd}.time_since_epoch().count());
+}
+
+std::string formatDayNumber(int32_t day) {
+    if (day == kInvalidDay) return {};
+
+    std::chrono::year_month_day ymd{std::chrono::sys_days{std::chrono::days{day}}};
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "%04d-%02u-%02u", static_cast<int>(ymd.year()),
+                  static_cast<unsigned>(ymd.month()), static_cast<unsigned>(ymd.day()));
+    return buffer;
+}
+
+std::span<const double> FeatureTable::column(FeatureColumn c) const {
+    switch (c) {
+        case FeatureColumn::Open: return open;
+        case FeatureColumn::High: return high;
+        case FeatureColumn::Low: return low;
+        case FeatureColumn::Close: return close;
+        case FeatureColumn::AdjClose: return adj_close;
+        case FeatureColumn::Volume: return volume;
+        case FeatureColumn::DailyReturn: return daily_return;
+        case FeatureColumn::Volatility: return volatility;
+        case FeatureColumn::VolumeZScore: return volume_zscore;
+        default: return {};
+    }
+}
+
+std::vector<double>* FeatureTable::mutableColumn(FeatureColumn c) {
+    switch (c) {
+        case FeatureColumn::Open: return &open;
+        case FeatureColumn::High: return &high;
+        case FeatureColumn::Low: return &low;
+        case FeatureColumn::Close: return &close;
+        case FeatureColumn::AdjClose: return &adj_close;
+        case FeatureColumn::Volume: return &volume;
+        case FeatureColumn::DailyReturn: return &daily_return;
+        case FeatureColumn::Volatility: return &volatility;
+        case FeatureColumn::VolumeZScore: return &volume_zscore;
+        default: return nullptr;
+    }
+}
+
+uint32_t FeatureTable::internTicker(std::string_view ticker) {
+    auto it = ticker_lookup.find(ticker);
+    if (it != ticker_lookup.end()) return it->second;
+
+    uint32_t id = static_cast<uint32_t>(ticker_names.size());
+    ticker_names.emplace_back(ticker);
+    ticker_lookup.emplace(ticker_names.back(), id);
+    return id;
+}
+
+void FeatureTable::retainRows(std::span<const uint8_t> keep) {
+    auto compact = [&](auto& values) {
+        if (values.size() != keep.size()) return;
+        size_t kept = 0;
+        for (size_t row = 0; row < keep.size(); ++row) {
+            if (keep[row]) values[kept++] = values[row];
+        }
+        values.resize(kept);
+    };
+
+    compact(dates);
+    compact(ticker_ids);
+    for (size_t c = 0; c < kFeatureColumnCount; ++c) {
+        if (std::vector<double>* values = mutableColumn(static_cast<FeatureColumn>(c))) {
+            compact(*values);
+        }
+    }
+}
+
+void FeatureTable::clear() {
+    *this = FeatureTable();
+}
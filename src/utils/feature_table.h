@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "string_hash.h"
+
+// columns of features.csv, in file order
+enum class FeatureColumn {
+    Date, Open, High, Low, Close, AdjClose, Volume, Ticker, DailyReturn, Volatility, VolumeZScore
+};
+
+constexpr size_t kFeatureColumnCount = static_cast<size_t>(FeatureColumn::VolumeZScore) + 1;
+
+// Maps a CSV header name to its column, ignoring case, spaces and underscores
+// ("Daily Return", "daily_return" and "DailyReturn" all match). False if unknown.
+bool featureColumnFromName(std::string_view name, FeatureColumn& column);
+
+// Sentinel day number for dates that could not be parsed
+constexpr int32_t kInvalidDay = INT32_MIN;
+
+// "YYYY-MM-DD" -> days since 1970-01-01, or kInvalidDay
+int32_t parseDayNumber(std::string_view date);
+
+// days since 1970-01-01 -> "YYYY-MM-DD"
+std::string formatDayNumber(int32_t day);
+
+// Column-oriented (structure-of-arrays) copy of features.csv. Every numeric column
+// is its own contiguous vector, tickers are dictionary-encoded as small integer ids
+// and dates are packed as day numbers, so a scan over one column is unit-stride.
+// Numeric columns that were not loaded are left empty.
+struct FeatureTable {
+    std::vector<int32_t> dates;           // days since 1970-01-01
+    std::vector<uint32_t> ticker_ids;     // index into ticker_names
+    std::vector<std::string> ticker_names;
+
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<double> adj_close;
+    std::vector<double> volume;
+    std::vector<double> daily_return;
+    std::vector<double> volatility;
+    std::vector<double> volume_zscore;
+
+    size_t size() const { return ticker_ids.size(); }
+
+    // Numeric column by name; empty for Date/Ticker and for columns that weren't loaded
+    std::span<const double> column(FeatureColumn c) const;
+    std::vector<double>* mutableColumn(FeatureColumn c);
+
+    // Returns the id for a ticker, adding it to the dictionary on first sight
+    uint32_t internTicker(std::string_view ticker);
+
+    const std::string& tickerName(size_t row) const { return ticker_names[ticker_ids[row]]; }
+
+    // Drops every row whose keep flag is 0, compacting all loaded columns in place
+    void retainRows(std::span<const uint8_t> keep);
+
+    void clear();
+
+private:
+    std::unordered_map<std::string, uint32_t, TransparentStringHash, std::equal_to<>> ticker_lookup;
+};
@@ -0,0 +1,70 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+MappedFile::MappedFile(const std::string& filename) {
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return;
+    file_handle = file;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) return;
+    if (file_size.QuadPart == 0) {
+        opened = true;
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) return;
+    mapping_handle = mapping;
+
+    address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (address != nullptr) {
+        length = static_cast<size_t>(file_size.QuadPart);
+        opened = true;
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (address) UnmapViewOfFile(address);
+    if (mapping_handle) CloseHandle(static_cast<HANDLE>(mapping_handle));
+    if (file_handle) CloseHandle(static_cast<HANDLE>(file_handle));
+}
+
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return;
+    }
+    length = static_cast<size_t>(info.st_size);
+
+    if (length > 0) {
+        void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            address = mapped;
+            ::madvise(address, length, MADV_SEQUENTIAL);
+        }
+    }
+    ::close(fd);  // the mapping keeps its own reference to the file
+
+    opened = length == 0 || address != nullptr;
+    if (!opened) length = 0;
+}
+
+MappedFile::~MappedFile() {
+    if (address) ::munmap(address, length);
+}
+#endif
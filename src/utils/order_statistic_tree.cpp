@@ -0,0 +1,120 @@
+#include "order_statistic_tree.h"
+
+int32_t OrderStatisticTree::newNode(double value) {
+    // xorshift32 priorities keep the treap balanced in expectation
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    Node node{value, rng_state, 1, -1, -1};
+
+    if (!free_list.empty()) {
+        int32_t t = free_list.back();
+        free_list.pop_back();
+        nodes[t] = node;
+        return t;
+    }
+    nodes.push_back(node);
+    return static_cast<int32_t>(nodes.size() - 1);
+}
+
+void OrderStatisticTree::update(int32_t t) {
+    Node& node = nodes[t];
+    node.size = 1 + (node.left < 0 ? 0 : nodes[node.left].size) +
+                (node.right < 0 ? 0 : nodes[node.right].size);
+}
+
+void OrderStatisticTree::split(int32_t t, double value, int32_t& less, int32_t& rest) {
+    if (t < 0) {
+        less = rest = -1;
+        return;
+    }
+    if (nodes[t].value < value) {
+        split(nodes[t].right, value, nodes[t].right, rest);
+        less = t;
+    } else {
+        split(nodes[t].left, value, less, nodes[t].left);
+        rest = t;
+    }
+    update(t);
+}
+
+int32_t OrderStatisticTree::merge(int32_t a, int32_t b) {
+    if (a < 0) return b;
+    if (b < 0) return a;
+    if (nodes[a].priority > nodes[b].priority) {
+        nodes[a].right = merge(nodes[a].right, b);
+        update(a);
+        return a;
+    }
+    nodes[b].left = merge(a, nodes[b].left);
+    update(b);
+    return b;
+}
+
+void OrderStatisticTree::insert(double value) {
+    int32_t node = newNode(value);
+    int32_t less, rest;
+    split(root, value, less, rest);
+    root = merge(merge(less, node), rest);
+}
+
+int32_t OrderStatisticTree::eraseFrom(int32_t t, double value, bool& erased) {
+    if (t < 0) return t;
+
+    Node& node = nodes[t];
+    if (node.value == value) {
+        erased = true;
+        free_list.push_back(t);
+        return merge(node.left, node.right);
+    }
+    if (value < node.value) {
+        nodes[t].left = eraseFrom(node.left, value, erased);
+    } else {
+        nodes[t].right = eraseFrom(node.right, value, erased);
+    }
+    update(t);
+    return t;
+}
+
+bool OrderStatisticTree::erase(double value) {
+    bool erased = false;
+    root = eraseFrom(root, value, erased);
+    return erased;
+}
+
+void OrderStatisticTree::clear() {
+    nodes.clear();
+    free_list.clear();
+    root = -1;
+}
+
+double OrderStatisticTree::kth(size_t k) const {
+    int32_t t = root;
+    while (true) {
+        const Node& node = nodes[t];
+        size_t left_size = node.left < 0 ? 0 : nodes[node.left].size;
+        if (k < left_size) {
+            t = node.left;
+        } else if (k == left_size) {
+            return node.value;
+        } else {
+            k -= left_size + 1;
+            t = node.right;
+        }
+    }
+}
+
+size_t OrderStatisticTree::countLess(double value) const {
+    size_t count = 0;
+    int32_t t = root;
+    while (t >= 0) {
+        const Node& node = nodes[t];
+        if (node.value < value) {
+            count += 1 + (node.left < 0 ? 0 : nodes[node.left].size);
+            t = node.right;
+        } else {
+            t = node.left;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Multiset of doubles with rank queries: insert, erase and k-th smallest in
+// expected O(log n). Implemented as a treap whose nodes carry subtree sizes.
+// Nodes live in one pool vector and are recycled through a free list, so once
+// the set has reached its working size no further allocations happen.
+class OrderStatisticTree {
+public:
+    void reserve(size_t n) { nodes.reserve(n); }
+
+    void insert(double value);
+    bool erase(double value);  // removes one copy; false if not present
+    void clear();
+
+    size_t size() const { return root < 0 ? 0 : nodes[root].size; }
+
+    // k-th smallest element, 0-based; k must be < size()
+    double kth(size_t k) const;
+
+    // Number of elements strictly less than value
+    size_t countLess(double value) const;
+
+private:
+    struct Node {
+        double value;
+        uint32_t priority;
+        uint32_t size;
+        int32_t left;
+        int32_t right;
+    };
+
+    int32_t newNode(double value);
+    void update(int32_t t);
+    void split(int32_t t, double value, int32_t& less, int32_t& rest);  // less: < value
+    int32_t merge(int32_t a, int32_t b);
+    int32_t eraseFrom(int32_t t, double value, bool& erased);
+
+    std::vector<Node> nodes;
+    std::vector<int32_t> free_list;
+    int32_t root = -1;
+    uint32_t rng_state = 0x9E3779B9u;
+};
@@ -0,0 +1,207 @@
+#include "phase_timer.h"
+
+#ifdef PROJECT3_PROFILE
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "allocation_counter.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+struct Sample {
+    std::chrono::steady_clock::time_point wall;
+    std::clock_t cpu;
+    AllocationSnapshot allocations;
+
+    static Sample now() {
+        return {std::chrono::steady_clock::now(), std::clock(), allocationSnapshot()};
+    }
+};
+
+struct PhaseRecord {
+    const char* name;  // a literal at every call site, so storing it never allocates
+    int thread;
+    int depth;
+    uint64_t rows;
+    Sample start;
+    AllocationSnapshot own_at_start;
+    double wall_ms = 0.0;
+    double cpu_ms = 0.0;
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;
+    bool finished = false;
+};
+
+double wallMs(const Sample& from, const Sample& to) {
+    return std::chrono::duration<double, std::milli>(to.wall - from.wall).count();
+}
+
+double cpuMs(const Sample& from, const Sample& to) {
+    return 1000.0 * static_cast<double>(to.cpu - from.cpu) / CLOCKS_PER_SEC;
+}
+
+// Process-lifetime state; the start sample is taken during static initialization.
+// phases is shared by every thread and guarded by lock.
+struct RunProfile {
+    // Reserved up front (before the start sample) so most runs never grow it
+    std::vector<PhaseRecord> phases = [] {
+        std::vector<PhaseRecord> reserved;
+        reserved.reserve(256);
+        return reserved;
+    }();
+    Sample start = Sample::now();
+    std::mutex lock;
+    int threads = 0;
+    // Allocations made by the profiler itself (growing phases), subtracted from every
+    // phase open at the time and from the totals
+    AllocationSnapshot own{};
+};
+
+RunProfile& profile() {
+    static RunProfile instance;
+    return instance;
+}
+
+// Touch the profile at startup so "since program start" means what it says
+const RunProfile& g_profile_init = profile();
+
+// Per-thread nesting; the id is assigned when the thread opens its first phase
+struct ThreadState {
+    int id = -1;
+    int depth = 0;
+};
+thread_local ThreadState t_thread;
+
+uint64_t peakRssKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss) / 1024;  // bytes on macOS
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss);          // kilobytes on Linux
+#endif
+#endif
+}
+
+double perSecond(uint64_t rows, double ms) {
+    return ms > 0.0 ? static_cast<double>(rows) * 1000.0 / ms : 0.0;
+}
+
+// Phase names are code literals, but escape quotes and backslashes anyway
+std::string jsonString(std::string_view text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+} // namespace
+
+ScopedPhase::ScopedPhase(const char* name, uint64_t rows) {
+    RunProfile& run = profile();
+    std::lock_guard<std::mutex> guard(run.lock);
+    if (t_thread.id < 0) t_thread.id = run.threads++;
+    index = run.phases.size();
+
+    // Growing the vector allocates; book it as the profiler's own, not the phases'
+    bool grows = run.phases.size() == run.phases.capacity();
+    AllocationSnapshot before = grows ? allocationSnapshot() : AllocationSnapshot{};
+    run.phases.push_back({name, t_thread.id, t_thread.depth++, rows, {}, {}});
+    if (grows) {
+        AllocationSnapshot after = allocationSnapshot();
+        run.own.count += after.count - before.count;
+        run.own.bytes += after.bytes - before.bytes;
+    }
+
+    // Sampled last, so nothing above is charged to this phase
+    PhaseRecord& phase = run.phases[index];
+    phase.own_at_start = run.own;
+    phase.start = Sample::now();
+}
+
+ScopedPhase::~ScopedPhase() {
+    Sample end = Sample::now();
+    RunProfile& run = profile();
+    std::lock_guard<std::mutex> guard(run.lock);
+    PhaseRecord& phase = run.phases[index];
+    phase.wall_ms = wallMs(phase.start, end);
+    phase.cpu_ms = cpuMs(phase.start, end);
+    phase.allocations = end.allocations.count - phase.start.allocations.count -
+                        (run.own.count - phase.own_at_start.count);
+    phase.allocated_bytes = end.allocations.bytes - phase.start.allocations.bytes -
+                            (run.own.bytes - phase.own_at_start.bytes);
+    phase.finished = true;
+    --t_thread.depth;
+}
+
+void ScopedPhase::setRows(uint64_t rows) {
+    RunProfile& run = profile();
+    std::lock_guard<std::mutex> guard(run.lock);
+    run.phases[index].rows = rows;
+}
+
+bool writeRunReport(const std::string& filename, uint64_t rows) {
+    RunProfile& run = profile();
+    Sample end = Sample::now();
+    std::lock_guard<std::mutex> guard(run.lock);
+    double wall_ms = wallMs(run.start, end);
+
+    std::ofstream out(filename);
+    if (!out) return false;
+
+    char number[64];
+    auto fixed = [&](double value) {
+        std::snprintf(number, sizeof(number), "%.3f", value);
+        return std::string(number);
+    };
+
+    out << "{\n";
+    out << "  \"wall_ms\": " << fixed(wall_ms) << ",\n";
+    out << "  \"cpu_ms\": " << fixed(cpuMs(run.start, end)) << ",\n";
+    out << "  \"rows\": " << rows << ",\n";
+    out << "  \"rows_per_sec\": " << fixed(perSecond(rows, wall_ms)) << ",\n";
+    out << "  \"peak_rss_kb\": " << peakRssKb() << ",\n";
+    out << "  \"allocations\": " << end.allocations.count - run.start.allocations.count - run.own.count << ",\n";
+    out << "  \"allocated_bytes\": " << end.allocations.bytes - run.start.allocations.bytes - run.own.bytes << ",\n";
+    out << "  \"phases\": [";
+
+    bool first = true;
+    for (const PhaseRecord& phase : run.phases) {
+        if (!phase.finished) continue;
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "    {\"name\": " << jsonString(phase.name)
+            << ", \"thread\": " << phase.thread
+            << ", \"depth\": " << phase.depth
+            << ", \"wall_ms\": " << fixed(phase.wall_ms)
+            << ", \"cpu_ms\": " << fixed(phase.cpu_ms)
+            << ", \"rows\": " << phase.rows
+            << ", \"rows_per_sec\": " << fixed(perSecond(phase.rows, phase.wall_ms))
+            << ", \"allocations\": " << phase.allocations
+            << ", \"allocated_bytes\": " << phase.allocated_bytes << "}";
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+#endif // PROJECT3_PROFILE
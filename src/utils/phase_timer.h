@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Scoped phase timers for the pipeline, compiled in only when PROJECT3_PROFILE is
+// defined (cmake -DPROJECT3_PROFILE=ON). Without it the macros expand to nothing, so
+// instrumented code costs nothing and phase_timer.cpp / allocation_counter.cpp need
+// not be linked.
+//
+//   PROFILE_PHASE("sliding window");            // times the enclosing scope
+//   PROFILE_PHASE_ROWS("load", table.size());   // same, with rows for rows/sec
+//   PROFILE_SCOPE(load, "load");                // named, for rows only known at the end:
+//   PROFILE_SET_ROWS(load, table.size());
+//   PROFILE_REPORT("../output/run_report.json", total_rows);
+//
+// Each phase records wall time, process CPU time and heap allocations between entry
+// and exit. Phases may nest; they are reported in entry order with their depth and the
+// thread that opened them (0 is the first thread to record a phase). Recording is
+// thread-safe, so library code called from worker threads may open phases too; CPU time
+// and allocations are process-wide, so they include whatever other threads did meanwhile.
+// The profiler's own bookkeeping is never charged to a phase.
+
+#ifdef PROJECT3_PROFILE
+
+class ScopedPhase {
+public:
+    explicit ScopedPhase(const char* name, uint64_t rows = 0);
+    ~ScopedPhase();
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    // Replaces the row count given at entry
+    void setRows(uint64_t rows);
+
+private:
+    size_t index;
+};
+
+// Writes the JSON run report: totals since program start (wall, CPU, rows/sec, peak
+// RSS, allocations) and every finished phase. False if the file can't be written.
+bool writeRunReport(const std::string& filename, uint64_t rows);
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_PHASE(name) ScopedPhase PROFILE_CONCAT(profile_phase_, __LINE__)(name)
+#define PROFILE_PHASE_ROWS(name, rows) ScopedPhase PROFILE_CONCAT(profile_phase_, __LINE__)(name, rows)
+#define PROFILE_SCOPE(var, name) ScopedPhase var(name)
+#define PROFILE_SET_ROWS(var, rows) var.setRows(rows)
+#define PROFILE_REPORT(filename, rows) writeRunReport(filename, rows)
+
+#else
+
+#define PROFILE_PHASE(name) ((void)0)
+#define PROFILE_PHASE_ROWS(name, rows) ((void)0)
+#define PROFILE_SCOPE(var, name) ((void)0)
+#define PROFILE_SET_ROWS(var, rows) ((void)0)
+#define PROFILE_REPORT(filename, rows) ((void)0)
+
+#endif
@@ -0,0 +1,100 @@
+#include "prefix_moments.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+PrefixMoments::PrefixMoments(std::span<const double> series)
+    : sum(series.size() + 1, 0.0), sum_sq(series.size() + 1, 0.0) {
+    size_t n = series.size();
+    block_shift.reserve((n + kBlockSize - 1) / kBlockSize);
+
+    for (size_t block_begin = 0; block_begin < n; block_begin += kBlockSize) {
+        size_t block_end = std::min(n, block_begin + kBlockSize);
+        double shift = std::accumulate(series.begin() + block_begin, series.begin() + block_end, 0.0) /
+                       static_cast<double>(block_end - block_begin);
+        block_shift.push_back(shift);
+
+        // Kahan summation; the stored prefix is the compensated total
+        double s = 0.0, c = 0.0, s2 = 0.0, c2 = 0.0;
+        for (size_t j = block_begin; j < block_end; ++j) {
+            double x = series[j] - shift;
+
+            double y = x - c;
+            double t = s + y;
+            c = (t - s) - y;
+            s = t;
+
+            double y2 = x * x - c2;
+            double t2 = s2 + y2;
+            c2 = (t2 - s2) - y2;
+            s2 = t2;
+
+            sum[j + 1] = s - c;
+            sum_sq[j + 1] = s2 - c2;
+        }
+    }
+}
+
+PrefixMoments::Moments PrefixMoments::reshift(const Moments& m, double from, double to) {
+    double delta = to - from;
+    return {m.count,
+            m.sum - m.count * delta,
+            m.sum_sq - 2.0 * delta * m.sum + m.count * delta * delta};
+}
+
+PrefixMoments::Moments PrefixMoments::blockTail(size_t begin) const {
+    size_t block_begin = begin / kBlockSize * kBlockSize;
+    size_t block_end = std::min(size(), block_begin + kBlockSize);
+    // sum[begin] belongs to the previous block when begin starts this one
+    double head = begin == block_begin ? 0.0 : sum[begin];
+    double head_sq = begin == block_begin ? 0.0 : sum_sq[begin];
+    return {static_cast<double>(block_end - begin), sum[block_end] - head, sum_sq[block_end] - head_sq};
+}
+
+void PrefixMoments::lowerSums(size_t block, size_t first, size_t last,
+                              double* lower_sum, double* lower_sum_sq) const {
+    double shift = block_shift[block];
+    size_t middle_from = static_cast<size_t>(-1);
+    Moments middle{0.0, 0.0, 0.0};  // whole blocks between begin's block and `block`
+
+    for (size_t begin = first; begin < last; ++begin) {
+        size_t begin_block = begin / kBlockSize;
+        if (begin_block >= block) {
+            // Same block as the window's end: the lower prefix is this block's own prefix
+            bool block_start = begin % kBlockSize == 0;
+            *lower_sum++ = block_start ? 0.0 : sum[begin];
+            *lower_sum_sq++ = block_start ? 0.0 : sum_sq[begin];
+            continue;
+        }
+
+        if (begin_block != middle_from) {
+            middle = {0.0, 0.0, 0.0};
+            for (size_t b = begin_block + 1; b < block; ++b) {
+                size_t end = (b + 1) * kBlockSize;
+                Moments full = reshift({static_cast<double>(kBlockSize), sum[end], sum_sq[end]},
+                                       block_shift[b], shift);
+                middle.sum += full.sum;
+                middle.sum_sq += full.sum_sq;
+            }
+            middle_from = begin_block;
+        }
+
+        // The window reaches back into earlier blocks: everything from begin up to this
+        // block's start, moved to this block's shift, is subtracted with the opposite sign
+        Moments tail = reshift(blockTail(begin), block_shift[begin_block], shift);
+        *lower_sum++ = -(tail.sum + middle.sum);
+        *lower_sum_sq++ = -(tail.sum_sq + middle.sum_sq);
+    }
+}
+
+void PrefixMoments::window(size_t begin, size_t end, double& mean, double& stddev) const {
+    size_t block = (end - 1) / kBlockSize;
+    double lower_sum, lower_sum_sq;
+    lowerSums(block, begin, begin + 1, &lower_sum, &lower_sum_sq);
+
+    double n = static_cast<double>(end - begin);
+    double centered_mean = (sum[end] - lower_sum) / n;
+    double variance = (sum_sq[end] - lower_sum_sq) / n - centered_mean * centered_mean;
+    mean = centered_mean + block_shift[block];
+    stddev = variance > 0.0 ? std::sqrt(variance) : 0.0;
+}
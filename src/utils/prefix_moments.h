@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Prefix sums of x and x^2 for O(1) mean/stddev of any window of a fixed series.
+//
+// The sums restart at every block of kBlockSize values, and each block is shifted by
+// its own mean before summing. A window is the difference of two prefixes, so its
+// rounding error scales with the size of those prefixes: anchoring them per block keeps
+// that error bounded by the block's spread rather than growing with the window's
+// position in the series (or with how far a level shift moves the data from a global
+// mean). Sums inside a block are Kahan-compensated.
+//
+// Error bound: a window's variance has an absolute error of about
+//   eps * (kBlockSize + W) / W * s^2
+// where s^2 is the largest mean of (x - c)^2 over the blocks the window touches and c is
+// the shift of the block the window ends in. It does not grow with the series length.
+class PrefixMoments {
+public:
+    static constexpr size_t kBlockSize = 4096;
+
+    explicit PrefixMoments(std::span<const double> series);
+
+    size_t size() const { return sum.size() - 1; }
+
+    // Mean and population standard deviation of series[begin, end); end > begin
+    void window(size_t begin, size_t end, double& mean, double& stddev) const;
+
+    // Mean of the block'th kBlockSize values, which that block's sums are shifted by
+    double blockShift(size_t block) const { return block_shift[block]; }
+
+private:
+    // Lower prefixes for windows whose last element is in `block`: for every begin in
+    // [first, last), writes the values that, subtracted from sum[end] and sum_sq[end],
+    // give the window's shifted sums. Requires first <= last <= (block + 1) * kBlockSize.
+    // Entry j >= 1 of sum/sum_sq covers series[block_start, j) of the block holding
+    // element j - 1, shifted by that block's mean.
+    void lowerSums(size_t block, size_t first, size_t last,
+                   double* lower_sum, double* lower_sum_sq) const;
+
+    // Sums of x - c and (x - c)^2 for some shift c
+    struct Moments {
+        double count;
+        double sum;
+        double sum_sq;
+    };
+
+    // m moved from shift `from` to shift `to`
+    static Moments reshift(const Moments& m, double from, double to);
+
+    // series[begin, end of begin's block), shifted by that block's mean
+    Moments blockTail(size_t begin) const;
+
+    std::vector<double> sum;
+    std::vector<double> sum_sq;
+    std::vector<double> block_shift;
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// Contiguous fixed-capacity circular buffer. Storage is allocated once up front
+// (or inline when Capacity is given at compile time), so pushes never allocate.
+//   RingBuffer<double>      - capacity chosen at construction
+//   RingBuffer<double, 32>  - capacity fixed at compile time, stored inline
+template <typename T, size_t Capacity = 0>
+class RingBuffer {
+public:
+    RingBuffer() requires (Capacity != 0) = default;
+    explicit RingBuffer(size_t capacity) requires (Capacity == 0) : storage(capacity) {}
+
+    size_t size() const { return count; }
+    size_t capacity() const { return storage.size(); }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == storage.size(); }
+
+    // i = 0 is the oldest element
+    const T& operator[](size_t i) const { return storage[wrap(head + i)]; }
+    const T& front() const { return storage[head]; }
+    const T& back() const { return storage[wrap(head + count - 1)]; }
+
+    // Caller must ensure the buffer is not full
+    void push_back(const T& value) {
+        storage[wrap(head + count)] = value;
+        ++count;
+    }
+
+    void pop_front() {
+        head = wrap(head + 1);
+        --count;
+    }
+
+    // Overwrites the oldest element of a full buffer and returns it
+    T replace_oldest(const T& value) {
+        T old = storage[head];
+        storage[head] = value;
+        head = wrap(head + 1);
+        return old;
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+
+private:
+    // Indices never exceed 2 * capacity, so a compare beats a modulo
+    size_t wrap(size_t i) const { return i >= storage.size() ? i - storage.size() : i; }
+
+    std::conditional_t<Capacity == 0, std::vector<T>, std::array<T, Capacity>> storage{};
+    size_t head = 0;
+    size_t count = 0;
+};
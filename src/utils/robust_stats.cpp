@@ -0,0 +1,266 @@
+#include "robust_stats.h"
+#include <algorithm>
+#include <cmath>
+
+double medianInPlace(std::span<double> values) {
+    size_t n = values.size();
+    if (n == 0) return 0.0;
+
+    auto mid = values.begin() + n / 2;
+    std::nth_element(values.begin(), mid, values.end());
+    double upper = *mid;
+    if (n % 2 != 0) {
+        return upper;
+    }
+
+    // After nth_element everything left of mid is <= *mid, so the lower
+    // middle value is simply the largest element of that half
+    double lower = *std::max_element(values.begin(), mid);
+    return (lower + upper) / 2.0;
+}
+
+RobustStats computeMedianMAD(std::span<const double> data, std::vector<double>& scratch) {
+    RobustStats stats;
+    if (data.empty()) return stats;
+
+    scratch.assign(data.begin(), data.end());
+    stats.median = medianInPlace(scratch);
+
+    // The order of scratch no longer matters, so deviations can overwrite it
+    for (double& value : scratch) {
+        value = std::abs(value - stats.median);
+    }
+    stats.mad = medianInPlace(scratch);
+
+    return stats;
+}
+
+RobustStats computeMedianMAD(std::span<const double> data) {
+    std::vector<double> scratch;
+    return computeMedianMAD(data, scratch);
+}
+
+namespace {
+
+constexpr double kMinMagnitude = 1e-12;
+
+// Value at 0-based rank r of a weighted, sorted (value, count) sequence
+template <typename Iter>
+double valueAtRank(Iter begin, Iter end, uint64_t rank) {
+    uint64_t seen = 0;
+    for (Iter it = begin; it != end; ++it) {
+        seen += it->second;
+        if (rank < seen) return it->first;
+    }
+    return 0.0;
+}
+
+} // namespace
+
+StreamingRobustStats::StreamingRobustStats(double relative_accuracy) {
+    double alpha = std::clamp(relative_accuracy, 1e-6, 0.5);
+    gamma = (1.0 + alpha) / (1.0 - alpha);
+    log_gamma = std::log(gamma);
+}
+
+void StreamingRobustStats::Store::add(int index) {
+    if (counts.empty()) {
+        offset = index;
+        counts.push_back(0);
+    } else if (index < offset) {
+        counts.insert(counts.begin(), static_cast<size_t>(offset - index), 0);
+        offset = index;
+    } else if (index - offset >= static_cast<int>(counts.size())) {
+        counts.resize(static_cast<size_t>(index - offset) + 1, 0);
+    }
+    ++counts[static_cast<size_t>(index - offset)];
+}
+
+int StreamingRobustStats::bucketIndex(double magnitude) const {
+    return static_cast<int>(std::ceil(std::log(magnitude) / log_gamma));
+}
+
+double StreamingRobustStats::bucketValue(int index) const {
+    // Bucket k covers (gamma^(k-1), gamma^k]; this point is within alpha of both ends
+    return 2.0 * std::pow(gamma, index) / (gamma + 1.0);
+}
+
+void StreamingRobustStats::add(double value) {
+    // NaN has no rank, and +-inf (e.g. a return off a zero close) has no finite bucket
+    if (!std::isfinite(value)) return;
+
+    ++total;
+    double magnitude = std::abs(value);
+    if (magnitude < kMinMagnitude) {
+        ++zero_count;
+    } else if (value > 0) {
+        positive.add(bucketIndex(magnitude));
+    } else {
+        negative.add(bucketIndex(magnitude));
+    }
+}
+
+std::vector<std::pair<double, uint64_t>> StreamingRobustStats::ascendingBuckets() const {
+    std::vector<std::pair<double, uint64_t>> buckets;
+    buckets.reserve(bucketCount());
+
+    // Most negative first: negative buckets by decreasing magnitude
+    for (size_t i = negative.counts.size(); i-- > 0;) {
+        if (negative.counts[i]) {
+            buckets.push_back({-bucketValue(negative.offset + static_cast<int>(i)), negative.counts[i]});
+        }
+    }
+    if (zero_count) {
+        buckets.push_back({0.0, zero_count});
+    }
+    for (size_t i = 0; i < positive.counts.size(); ++i) {
+        if (positive.counts[i]) {
+            buckets.push_back({bucketValue(positive.offset + static_cast<int>(i)), positive.counts[i]});
+        }
+    }
+    return buckets;
+}
+
+RobustStats StreamingRobustStats::stats() const {
+    RobustStats result;
+    if (total == 0) return result;
+
+    auto buckets = ascendingBuckets();
+    uint64_t lower_rank = (total - 1) / 2;
+    uint64_t upper_rank = total / 2;
+    result.median = (valueAtRank(buckets.begin(), buckets.end(), lower_rank) +
+                     valueAtRank(buckets.begin(), buckets.end(), upper_rank)) / 2.0;
+
+    // |v - median| is already sorted on each side of the median, so merging the two
+    // sides outward gives the deviations in ascending order without a sort
+    size_t split = static_cast<size_t>(
+        std::lower_bound(buckets.begin(), buckets.end(), result.median,
+                         [](const auto& bucket, double m) { return bucket.first < m; }) - buckets.begin());
+    std::vector<std::pair<double, uint64_t>> deviations;
+    deviations.reserve(buckets.size());
+    size_t left = split, right = split;
+    while (left > 0 || right < buckets.size()) {
+        bool take_left = right == buckets.size() ||
+                         (left > 0 && result.median - buckets[left - 1].first <= buckets[right].first - result.median);
+        if (take_left) {
+            --left;
+            deviations.push_back({result.median - buckets[left].first, buckets[left].second});
+        } else {
+            deviations.push_back({buckets[right].first - result.median, buckets[right].second});
+            ++right;
+        }
+    }
+
+    result.mad = (valueAtRank(deviations.begin(), deviations.end(), lower_rank) +
+                  valueAtRank(deviations.begin(), deviations.end(), upper_rank)) / 2.0;
+    return result;
+}
+
+namespace {
+
+// k-th smallest (0-based) of |x - median| over n sorted values reachable by rank through
+// kth. The values below the median give one ascending run of deviations (walking down
+// from the median) and the rest give another (walking up), so this is a
+// k-th-of-two-sorted-lists search.
+template <typename Kth>
+double kthDeviation(Kth kth, size_t n, double median, size_t below, size_t k) {
+    size_t a = below;       // run A[i] = median - kth(below - 1 - i)
+    size_t b = n - below;   // run B[j] = kth(below + j) - median
+    auto A = [&](size_t i) { return median - kth(below - 1 - i); };
+    auto B = [&](size_t j) { return kth(below + j) - median; };
+
+    // Binary search for how many of the k + 1 smallest deviations come from A
+    size_t lo = k + 1 > b ? k + 1 - b : 0;
+    size_t hi = std::min(a, k + 1);
+    while (lo < hi) {
+        size_t t = (lo + hi) / 2;
+        if (A(t) < B(k - t)) {
+            lo = t + 1;
+        } else {
+            hi = t;
+        }
+    }
+
+    double result = 0.0;
+    if (lo > 0) result = A(lo - 1);
+    if (k + 1 > lo) result = std::max(result, B(k - lo));
+    return result;
+}
+
+// Median and MAD of n sorted values reachable by rank; below(m) counts values < m
+template <typename Kth, typename CountLess>
+RobustStats sortedMedianMAD(Kth kth, CountLess count_less, size_t n) {
+    RobustStats result;
+    if (n == 0) return result;
+
+    result.median = (kth((n - 1) / 2) + kth(n / 2)) / 2.0;
+    size_t below = count_less(result.median);
+    result.mad = (kthDeviation(kth, n, result.median, below, (n - 1) / 2) +
+                  kthDeviation(kth, n, result.median, below, n / 2)) / 2.0;
+    return result;
+}
+
+} // namespace
+
+// A window needs at least one slot; an empty ring buffer would be "full" from the start
+RollingMedianMAD::RollingMedianMAD(int window_size)
+    : window(static_cast<size_t>(std::max(window_size, 1))),
+      use_tree(window.capacity() > kSortedArrayMax) {
+    if (use_tree) {
+        sorted.reserve(window.capacity() + 1);
+    } else {
+        sorted_array.reserve(window.capacity());
+    }
+}
+
+void RollingMedianMAD::add(double value) {
+    // NaN compares false both ways, so it could never be found again to erase it
+    if (std::isnan(value)) return;
+
+    if (!use_tree) {
+        if (window.full()) {
+            double oldest = window.replace_oldest(value);
+            sorted_array.erase(std::lower_bound(sorted_array.begin(), sorted_array.end(), oldest));
+        } else {
+            window.push_back(value);
+        }
+        sorted_array.insert(std::upper_bound(sorted_array.begin(), sorted_array.end(), value), value);
+        return;
+    }
+
+    if (window.full()) {
+        sorted.erase(window.replace_oldest(value));
+    } else {
+        window.push_back(value);
+    }
+    sorted.insert(value);
+}
+
+double RollingMedianMAD::median() const {
+    if (!use_tree) {
+        size_t n = sorted_array.size();
+        return n == 0 ? 0.0 : (sorted_array[(n - 1) / 2] + sorted_array[n / 2]) / 2.0;
+    }
+    size_t n = sorted.size();
+    return n == 0 ? 0.0 : (sorted.kth((n - 1) / 2) + sorted.kth(n / 2)) / 2.0;
+}
+
+double RollingMedianMAD::mad() const {
+    return stats().mad;
+}
+
+RobustStats RollingMedianMAD::stats() const {
+    if (!use_tree) {
+        const double* values = sorted_array.data();
+        return sortedMedianMAD([values](size_t k) { return values[k]; },
+                               [this](double m) {
+                                   return static_cast<size_t>(
+                                       std::lower_bound(sorted_array.begin(), sorted_array.end(), m) -
+                                       sorted_array.begin());
+                               },
+                               sorted_array.size());
+    }
+    return sortedMedianMAD([this](size_t k) { return sorted.kth(k); },
+                           [this](double m) { return sorted.countLess(m); },
+                           sorted.size());
+}
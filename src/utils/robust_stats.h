@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+#include "order_statistic_tree.h"
+#include "ring_buffer.h"
+
+// Median and MAD (median absolute deviation) of a sample
+struct RobustStats {
+    double median = 0.0;
+    double mad = 0.0;
+};
+
+// Median of values using selection (std::nth_element), expected O(n).
+// Reorders values in place. For even n this is the mean of the two middle values.
+double medianInPlace(std::span<double> values);
+
+// Median and MAD of data with two selection passes over a single scratch buffer:
+// the copy is selected for the median, then overwritten with |x - median| and
+// selected again. Pass a scratch vector to reuse its allocation across calls.
+RobustStats computeMedianMAD(std::span<const double> data, std::vector<double>& scratch);
+RobustStats computeMedianMAD(std::span<const double> data);
+
+// Online approximate median/MAD over an unbounded stream in O(sketch) memory.
+// Values are counted in logarithmic buckets (a DDSketch-style quantile sketch): every
+// value is represented to within a relative error of relative_accuracy (alpha), so
+//   |median() - true median| <= alpha * |true median|   (odd count, or same-sign middle pair)
+//   |mad() - true MAD|       <= alpha * (2 * |true median| + true MAD)
+// Magnitudes below 1e-12 are counted as exactly zero; NaN and +-inf are ignored. Memory
+// grows with the log of the value range: about ln(max/min) / (2 * alpha) buckets,
+// ~1500 for features.csv daily returns at 1%.
+// add() is O(1) amortized; median()/mad()/stats() walk the buckets, O(buckets).
+class StreamingRobustStats {
+public:
+    explicit StreamingRobustStats(double relative_accuracy = 0.01);
+
+    void add(double value);
+
+    size_t count() const { return static_cast<size_t>(total); }
+    size_t bucketCount() const { return positive.counts.size() + negative.counts.size() + 1; }
+
+    double median() const { return stats().median; }
+    double mad() const { return stats().mad; }
+    RobustStats stats() const;
+
+private:
+    // Dense run of bucket counts starting at bucket index `offset`
+    struct Store {
+        std::vector<uint64_t> counts;
+        int offset = 0;
+        void add(int index);
+    };
+
+    int bucketIndex(double magnitude) const;
+    double bucketValue(int index) const;
+
+    // (representative value, count) pairs in ascending value order
+    std::vector<std::pair<double, uint64_t>> ascendingBuckets() const;
+
+    double gamma;
+    double log_gamma;
+    Store positive;
+    Store negative;  // indexed by magnitude
+    uint64_t zero_count = 0;
+    uint64_t total = 0;
+};
+
+// Exact median and MAD over the last window_size values, for rolling (Hampel-style)
+// detection. The window is kept in arrival order (ring buffer, for eviction) and in
+// sorted order, so nothing is ever re-sorted. Windows up to kSortedArrayMax values are
+// sorted in a flat array; a shifted insert/erase beats tree walks until the window is
+// well past 16k values (Project3_bench BM_Hampel):
+//   add()             O(W) memmove
+//   median()          O(1)
+//   mad()             O(log W): k-th smallest of the two sorted deviation runs either side of the median
+// Larger windows use an order-statistic tree:
+//   add()             O(log W)
+//   median()          O(log W)
+//   mad()             O(log^2 W)
+// NaN values are skipped (the window holds the last window_size non-NaN values), and a
+// window_size below 1 is treated as 1.
+class RollingMedianMAD {
+public:
+    static constexpr size_t kSortedArrayMax = 16384;
+
+    explicit RollingMedianMAD(int window_size);
+
+    void add(double value);
+    bool ready() const { return window.full(); }
+
+    double median() const;
+    double mad() const;
+    RobustStats stats() const;
+
+private:
+    RingBuffer<double> window;
+    bool use_tree;
+    std::vector<double> sorted_array;
+    OrderStatisticTree sorted;
+};
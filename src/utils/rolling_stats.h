@@ -1,16 +1,67 @@
 #pragma once
-#include <deque>
+#include <cmath>
+#include <cstddef>
+#include "ring_buffer.h"
 
-class RollingStats {
+// Rolling mean / population standard deviation over the last window_size values.
+// Running moments are updated with Welford's method on every add(), so mean()
+// and stddev() are O(1) regardless of the window size. The window lives in a
+// preallocated ring buffer, so add() never allocates after construction.
+//   RollingStats stats(30)        - window size chosen at runtime
+//   BasicRollingStats<30> stats;  - window size fixed at compile time, stored inline
+template <size_t Capacity = 0>
+class BasicRollingStats {
 public:
-    RollingStats(int window_size);
+    BasicRollingStats(int window_size) requires (Capacity == 0)
+        : window(static_cast<size_t>(window_size)) {}
+    BasicRollingStats() requires (Capacity != 0) = default;
 
-    void add(double value);
-    double mean() const;
-    double stddev() const;
-    bool ready() const;
+    void add(double value) {
+        if (window.full()) {
+            // Full window: replace the oldest value with the new one in a single update
+            double old_value = window.replace_oldest(value);
+            double old_mean = running_mean;
+            running_mean += (value - old_value) / static_cast<double>(window.size());
+            m2 += (value - old_value) * (value - running_mean + old_value - old_mean);
+        } else {
+            // Still filling: standard Welford step
+            window.push_back(value);
+            double delta = value - running_mean;
+            running_mean += delta / static_cast<double>(window.size());
+            m2 += delta * (value - running_mean);
+        }
+
+        // Guard against tiny negative values from cancellation
+        if (m2 < 0.0) {
+            m2 = 0.0;
+        }
+    }
+
+    double mean() const {
+        if (window.empty()) return 0.0;
+        return running_mean;
+    }
+
+    double stddev() const {
+        if (window.empty()) return 0.0;
+        return std::sqrt(m2 / static_cast<double>(window.size()));
+    }
+
+    // Sample (n - 1) standard deviation, what pandas' rolling().std() reports; 0 below 2 values
+    double sampleStddev() const {
+        if (window.size() < 2) return 0.0;
+        return std::sqrt(m2 / static_cast<double>(window.size() - 1));
+    }
+
+    bool ready() const { return window.full(); }
 
 private:
-    int window_size;
-    std::deque<double> window;
+    RingBuffer<double, Capacity> window;
+    double running_mean = 0.0;
+    double m2 = 0.0;  // sum of squared deviations from running_mean
 };
+
+using RollingStats = BasicRollingStats<>;
+
+// The runtime-sized variant is compiled once in rolling_stats.cpp
+extern template class BasicRollingStats<0>;
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+// Hash for std::string-keyed unordered containers that can also be probed with a
+// string_view (heterogeneous lookup), avoiding a temporary std::string per lookup.
+// Use together with std::equal_to<>.
+struct TransparentStringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
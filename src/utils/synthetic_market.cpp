@@ -0,0 +1,125 @@
+#include "synthetic_market.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "thread_pool.h"
+
+namespace {
+
+// Consecutive weekdays starting from 2010-01-04 (a Monday)
+std::vector<int32_t> tradingDays(size_t count) {
+    std::vector<int32_t> days;
+    days.reserve(count);
+    int32_t day = parseDayNumber("2010-01-04");
+    while (days.size() < count) {
+        // 1970-01-01 was a Thursday, so weekday 0 = Monday is (day + 3) % 7
+        if ((day + 3) % 7 < 5) days.push_back(day);
+        ++day;
+    }
+    return days;
+}
+
+// Fills ticker's rows (stride = ticker count) and returns the rows it injected
+std::vector<uint64_t> generateTicker(const SyntheticMarketConfig& config, size_t ticker, FeatureTable& table) {
+    // Independent stream per ticker: seed_seq mixes the seed and the ticker id
+    std::seed_seq seq{static_cast<uint32_t>(config.seed), static_cast<uint32_t>(config.seed >> 32),
+                      static_cast<uint32_t>(ticker), 0x5eedu};
+    std::mt19937_64 rng(seq);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::student_t_distribution<double> student(config.tail_dof > 2.0 ? config.tail_dof : 3.0);
+    std::exponential_distribution<double> jitter(2.0);
+
+    // Student-t has variance dof / (dof - 2); rescale to unit variance
+    bool fat_tails = config.tail_dof > 2.0;
+    double tail_scale = fat_tails ? std::sqrt((config.tail_dof - 2.0) / config.tail_dof) : 1.0;
+
+    double ticker_volatility = config.volatility * std::exp2(uniform(rng) * 2.0 - 1.0);
+    double base_volume = 1e6 * std::exp(normal(rng) * 1.5);
+    double close = 20.0 + uniform(rng) * 180.0;
+    bool turbulent = false;
+
+    std::vector<uint64_t> injected;
+    for (size_t day = 0; day < config.days; ++day) {
+        size_t row = day * config.tickers + ticker;
+
+        if (uniform(rng) < config.regime_switch_rate) turbulent = !turbulent;
+        double sigma = ticker_volatility * (turbulent ? config.turbulent_multiplier : 1.0);
+
+        double shock = fat_tails ? student(rng) * tail_scale : normal(rng);
+        double daily_return = config.drift + sigma * shock;
+        bool anomaly = uniform(rng) < config.anomaly_rate;
+        if (anomaly) {
+            double sign = uniform(rng) < 0.5 ? -1.0 : 1.0;
+            daily_return = config.drift + sign * sigma * (config.anomaly_magnitude + jitter(rng));
+            injected.push_back(row);
+        }
+        // Keep prices positive even for extreme draws
+        daily_return = std::max(daily_return, -0.95);
+        table.daily_return[row] = daily_return;
+
+        if (config.prices) {
+            double previous = close;
+            close *= 1.0 + daily_return;
+            double open = previous * (1.0 + sigma * 0.2 * normal(rng));
+            table.open[row] = open;
+            table.close[row] = close;
+            table.high[row] = std::max(open, close) * (1.0 + std::abs(normal(rng)) * sigma * 0.5);
+            table.low[row] = std::min(open, close) * (1.0 - std::abs(normal(rng)) * sigma * 0.5);
+
+            double activity = (turbulent ? 1.8 : 1.0) * (anomaly ? 3.0 : 1.0);
+            table.volume[row] = std::round(base_volume * activity * std::exp(normal(rng) * 0.3));
+        }
+    }
+    return injected;
+}
+
+} // namespace
+
+void generateSyntheticMarket(const SyntheticMarketConfig& config,
+                             FeatureTable& table,
+                             AnomalyMask& truth,
+                             WorkStealingPool* pool) {
+    table.clear();
+    size_t rows = config.tickers * config.days;
+
+    for (size_t ticker = 0; ticker < config.tickers; ++ticker) {
+        char name[24];
+        std::snprintf(name, sizeof(name), "SYN%04zu", ticker);
+        table.internTicker(name);
+    }
+
+    std::vector<int32_t> days = tradingDays(config.days);
+    table.dates.resize(rows);
+    table.ticker_ids.resize(rows);
+    for (size_t day = 0; day < config.days; ++day) {
+        for (size_t ticker = 0; ticker < config.tickers; ++ticker) {
+            table.dates[day * config.tickers + ticker] = days[day];
+            table.ticker_ids[day * config.tickers + ticker] = static_cast<uint32_t>(ticker);
+        }
+    }
+
+    table.daily_return.resize(rows);
+    if (config.prices) {
+        for (FeatureColumn c : {FeatureColumn::Open, FeatureColumn::High, FeatureColumn::Low,
+                                FeatureColumn::Close, FeatureColumn::Volume}) {
+            table.mutableColumn(c)->resize(rows);
+        }
+    }
+
+    // Tickers write disjoint rows, so they can be generated concurrently
+    std::vector<std::vector<uint64_t>> injected(config.tickers);
+    auto generate = [&](size_t ticker) { injected[ticker] = generateTicker(config, ticker, table); };
+    if (pool) {
+        pool->parallelFor(config.tickers, generate);
+    } else {
+        for (size_t ticker = 0; ticker < config.tickers; ++ticker) generate(ticker);
+    }
+
+    truth = AnomalyMask(rows);
+    for (const auto& rows_of_ticker : injected) {
+        for (uint64_t row : rows_of_ticker) truth.set(row);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "anomaly_mask.h"
+#include "feature_table.h"
+
+class WorkStealingPool;
+
+// Knobs for generateSyntheticMarket. Defaults give roughly features.csv's shape
+// (50 tickers, ~15 years of trading days) with realistic daily-return statistics.
+struct SyntheticMarketConfig {
+    size_t tickers = 50;
+    size_t days = 3750;                  // trading days per ticker; rows = tickers * days
+    uint64_t seed = 42;
+
+    double drift = 0.0003;               // mean daily return
+    double volatility = 0.015;           // calm-regime daily stddev (scaled 0.5-2x per ticker)
+    double turbulent_multiplier = 3.0;   // stddev multiplier in the turbulent regime
+    double regime_switch_rate = 0.01;    // daily probability of flipping regime
+    double tail_dof = 4.0;               // Student-t degrees of freedom; <= 2 means Gaussian
+
+    double anomaly_rate = 0.001;         // fraction of rows replaced by an injected jump
+    double anomaly_magnitude = 8.0;      // jump size in current-regime stddevs (plus jitter)
+
+    bool prices = true;                  // also fill Open/High/Low/Close/Volume
+};
+
+// Generates a date-major multi-ticker table like features.csv: dates are consecutive
+// weekdays from 2010-01-04, ticker ids are SYN0000... in order, and DailyReturn is the
+// generated return (Close follows from it). Each ticker switches between a calm and a
+// turbulent regime (two-state Markov chain), draws fat-tailed unit-variance Student-t
+// shocks, and has jumps of +-anomaly_magnitude stddevs injected at anomaly_rate.
+// Volatility/VolumeZScore are left empty; run computeFeatures on Close/Volume for them.
+//
+// Every ticker has its own RNG stream derived from the seed, so output is identical for
+// a given config whether or not a pool is passed to generate tickers in parallel.
+//
+// @param truth: Set to the injected rows, for precision/recall checks of the detectors
+void generateSyntheticMarket(const SyntheticMarketConfig& config,
+                             FeatureTable& table,
+                             AnomalyMask& truth,
+                             WorkStealingPool* pool = nullptr);
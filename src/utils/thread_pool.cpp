@@ -0,0 +1,100 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < num_threads; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (unsigned i = 0; i < num_threads; ++i) {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        stopping = true;
+    }
+    work_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) return;
+
+    std::unique_lock<std::mutex> lock(state_mutex);
+    current_task = &task;
+    first_error = nullptr;
+    remaining = count;
+
+    for (size_t i = 0; i < count; ++i) {
+        WorkerQueue& queue = *queues[i % queues.size()];
+        std::lock_guard<std::mutex> queue_lock(queue.mutex);
+        queue.items.push_back(i);
+    }
+
+    ++generation;
+    work_cv.notify_all();
+    done_cv.wait(lock, [this] { return remaining == 0; });
+
+    current_task = nullptr;
+    if (first_error) {
+        std::rethrow_exception(first_error);
+    }
+}
+
+void WorkStealingPool::workerLoop(size_t id) {
+    size_t seen_generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            work_cv.wait(lock, [&] { return stopping || generation != seen_generation; });
+            if (stopping) return;
+            seen_generation = generation;
+        }
+
+        size_t item;
+        while (popLocal(id, item) || steal(id, item)) {
+            try {
+                (*current_task)(item);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                if (!first_error) first_error = std::current_exception();
+            }
+
+            if (remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                done_cv.notify_all();
+            }
+        }
+    }
+}
+
+bool WorkStealingPool::popLocal(size_t id, size_t& item) {
+    WorkerQueue& queue = *queues[id];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.items.empty()) return false;
+    item = queue.items.front();
+    queue.items.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t id, size_t& item) {
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue& victim = *queues[(id + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.items.empty()) {
+            item = victim.items.back();
+            victim.items.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads with one task queue per worker.
+// A worker drains its own queue from the front and, once empty, steals from the
+// back of the other queues, so uneven task sizes still keep every core busy.
+class WorkStealingPool {
+public:
+    // num_threads = 0 uses std::thread::hardware_concurrency()
+    explicit WorkStealingPool(unsigned num_threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // Runs task(i) for every i in [0, count) and blocks until all have finished.
+    // Items are dealt round-robin in index order, so pass the most expensive first.
+    // The first exception thrown by a task is rethrown here.
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<size_t> items;
+    };
+
+    void workerLoop(size_t id);
+    bool popLocal(size_t id, size_t& item);
+    bool steal(size_t id, size_t& item);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+    std::mutex state_mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    const std::function<void(size_t)>* current_task = nullptr;
+    size_t generation = 0;
+    bool stopping = false;
+    std::atomic<size_t> remaining{0};
+    std::exception_ptr first_error;
+};
@@ -0,0 +1,49 @@
+#include "ticker_partition.h"
+#include <algorithm>
+#include <unordered_map>
+#include "phase_timer.h"
+
+std::vector<TickerSeries> partitionByTicker(const std::vector<double>& data,
+                                            const std::vector<std::string>& tickers) {
+    std::vector<TickerSeries> partitions;
+    std::unordered_map<std::string, size_t> slot_of;
+
+    size_t n = std::min(data.size(), tickers.size());
+    for (size_t i = 0; i < n; ++i) {
+        auto [it, inserted] = slot_of.try_emplace(tickers[i], partitions.size());
+        if (inserted) {
+            partitions.push_back({tickers[i], {}, {}});
+        }
+        TickerSeries& series = partitions[it->second];
+        series.values.push_back(data[i]);
+        series.row_indices.push_back(static_cast<int>(i));
+    }
+
+    return partitions;
+}
+
+std::vector<TickerSeries> partitionByTicker(const FeatureTable& table, FeatureColumn column) {
+    PROFILE_PHASE_ROWS("partition by ticker", table.size());
+    std::span<const double> values = table.column(column);
+    std::vector<TickerSeries> partitions(table.ticker_names.size());
+
+    // Count rows per ticker first so every series is allocated exactly once
+    std::vector<size_t> counts(partitions.size(), 0);
+    for (uint32_t id : table.ticker_ids) {
+        ++counts[id];
+    }
+    for (size_t id = 0; id < partitions.size(); ++id) {
+        partitions[id].ticker = table.ticker_names[id];
+        partitions[id].values.reserve(counts[id]);
+        partitions[id].row_indices.reserve(counts[id]);
+    }
+
+    size_t n = std::min(values.size(), table.size());
+    for (size_t i = 0; i < n; ++i) {
+        TickerSeries& series = partitions[table.ticker_ids[i]];
+        series.values.push_back(values[i]);
+        series.row_indices.push_back(static_cast<int>(i));
+    }
+
+    return partitions;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "feature_table.h"
+
+// One ticker's rows pulled out of the date-major features table
+struct TickerSeries {
+    std::string ticker;
+    std::vector<double> values;    // this ticker's values in file order
+    std::vector<int> row_indices;  // global row index of each value
+};
+
+// Splits a flat series into contiguous per-ticker series.
+// Partitions are ordered by each ticker's first appearance, so the result is deterministic.
+std::vector<TickerSeries> partitionByTicker(const std::vector<double>& data,
+                                            const std::vector<std::string>& tickers);
+
+// Same split driven by the table's dictionary-encoded ticker ids, so no string hashing
+// is needed. Partitions are ordered by ticker id, which is also first-appearance order.
+std::vector<TickerSeries> partitionByTicker(const FeatureTable& table, FeatureColumn column);